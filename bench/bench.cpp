@@ -0,0 +1,909 @@
+// Host benchmark suite, built by the `native` PlatformIO environment:
+//
+//   pio run -e native && .pio/build/native/program
+//
+// Every result is one JSON object per line:
+//   {"schema":1,"name":"draw.list_page","value":1234.567,"unit":"ns/frame"}
+// Names and units are stable between releases, so two runs can be compared line by line. Timings are host
+// CPU time and are only meaningful relative to another run on the same machine; byte and allocation counts
+// match the device.
+
+#include "menuDescriptor.h"
+#include "menu_data.h"
+#include "simpleUI.h"
+#include "staticPage.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#ifndef SIMPLEUI_DISPLAY_FRAMEBUFFER
+#error "The benchmarks need the framebuffer backend: build with -DSIMPLEUI_DISPLAY_FRAMEBUFFER"
+#endif
+
+#define BENCH_SCHEMA_VERSION 1
+#define BENCH_WARMUP 100
+#define BENCH_FRAMES 20000
+#define BENCH_EVENTS 20000
+#define BENCH_EDGES 1000000
+#define BENCH_LIST_ITEMS 8
+#define BENCH_VIRTUAL_ROWS 1000
+#define BENCH_PIN_A 20
+#define BENCH_PIN_B 21
+#define BENCH_DETENTS 2000
+#define BENCH_ISR_QUEUE_LENGTH 10 // QUEUE_LENGTH in rotaryDebounce.cpp
+#define BENCH_ISR_SERVICE_US 20   // time the queue task needs per edge
+#define BENCH_SWITCH_PIN 22
+#define BENCH_SWITCH_PRESSES 50 // per phase: the window learns in the first and must hold in the second
+#define BENCH_MENU_ITEMS 5       // in menu.txt
+#define BENCH_MENU_CALLBACKS 2
+
+// Allocation counter: every operator new and new[] in the process goes through here. The helpers are not
+// inlined, so the compiler does not pair the new expressions with malloc() and free() directly
+// (-Wmismatched-new-delete).
+static size_t s_allocations = 0;
+
+__attribute__((noinline)) static void *benchAllocate(size_t size)
+{
+  s_allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == nullptr)
+  {
+    abort();
+  }
+  return ptr;
+}
+
+__attribute__((noinline)) static void benchFree(void *ptr)
+{
+  free(ptr);
+}
+
+void *operator new(size_t size)
+{
+  return benchAllocate(size);
+}
+
+void *operator new[](size_t size)
+{
+  return benchAllocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  benchFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  benchFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  benchFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+  benchFree(ptr);
+}
+
+void switchDebounce_isr(void *arg);
+
+// Access to the private draw and decode entry points.
+struct SimpleUIBench
+{
+  static void draw(Container &container) { container.draw(); }
+  static void abInterrupt(RotaryDebounce &rotary, unsigned long ms) { rotary.abInterrupt(ms); }
+  // Direction of the detent the next edge completes, if it completes one: only S3 can move to S4.
+  static bool completing(RotaryDebounce &rotary, ROTARY_EVENT &direction)
+  {
+    direction = rotary.m_rotaryState.direction;
+    return rotary.m_rotaryState.phase == RotaryDebounce::S3;
+  }
+  static TimerHandle_t debounceTimer(SwitchDebounce &button) { return button.m_debounceTimer; }
+};
+
+static void report(const char *name, double value, const char *unit)
+{
+  printf("{\"schema\":%d,\"name\":\"%s\",\"value\":%.3f,\"unit\":\"%s\"}\n", BENCH_SCHEMA_VERSION, name, value, unit);
+}
+
+static double nowNs()
+{
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static char s_value[] = "42";
+
+static void onItemValue(Item *item, const Event *event)
+{
+  item->value = s_value;
+}
+
+static void onStaticItemValue(StaticPageItem *item, const Event *event)
+{
+  item->value = s_value;
+}
+
+struct BenchListSource : ListDataSource
+{
+  char m_label[16];
+
+  size_t count() override { return BENCH_VIRTUAL_ROWS; }
+  const char *label(size_t row) override
+  {
+    snprintf(m_label, sizeof(m_label), "Row %u", (unsigned)row);
+    return m_label;
+  }
+  const char *value(size_t row) override { return s_value; }
+};
+
+// CPU time and allocations of Container::draw() for one page.
+static void benchDraw(const char *name, Page &page)
+{
+  // Containers cannot be destroyed, so each benchmark keeps its own display and container for the run.
+  FramebufferDisplay &display = *new FramebufferDisplay();
+  Container &container = Container::create(display);
+  container.initDisplay();
+  container.addPage(page);
+  container.start();
+
+  for (int i = 0; i < BENCH_WARMUP; i++)
+  {
+    SimpleUIBench::draw(container);
+  }
+
+  size_t allocations = s_allocations;
+  double start = nowNs();
+  for (int i = 0; i < BENCH_FRAMES; i++)
+  {
+    SimpleUIBench::draw(container);
+  }
+  double elapsed = nowNs() - start;
+  allocations = s_allocations - allocations;
+
+  char metric[64];
+  snprintf(metric, sizeof(metric), "draw.%s", name);
+  report(metric, elapsed / BENCH_FRAMES, "ns/frame");
+  snprintf(metric, sizeof(metric), "alloc.%s", name);
+  report(metric, (double)allocations / BENCH_FRAMES, "allocs/frame");
+}
+
+static void sendEvent(Container &container, ROTARY_EVENT rEvent)
+{
+  Event event = {EVENT_ROT, (unsigned long)rEvent};
+  container.onEvent(event);
+}
+
+// CPU time per input event, from the event handler to the end of display(), frame bytes flushed and the
+// estimated bus bytes including addressing and commands.
+static void benchEvents(const char *name, Container &container, FramebufferDisplay &display, const ROTARY_EVENT *sequence, size_t sequenceLength)
+{
+  BusStats bus;
+  container.getBusStats(bus);
+  u_int32_t busBytes = bus.total.bytes;
+  u_int32_t bytes = display.flushedBytes();
+  u_int32_t flushes = display.flushCount();
+  double start = nowNs();
+  for (int i = 0; i < BENCH_EVENTS; i++)
+  {
+    sendEvent(container, sequence[i % sequenceLength]);
+  }
+  double elapsed = nowNs() - start;
+  bytes = display.flushedBytes() - bytes;
+  flushes = display.flushCount() - flushes;
+  container.getBusStats(bus);
+  busBytes = bus.total.bytes - busBytes;
+
+  char metric[64];
+  snprintf(metric, sizeof(metric), "event.%s", name);
+  report(metric, elapsed / BENCH_EVENTS, "ns/event");
+  snprintf(metric, sizeof(metric), "flush.%s", name);
+  report(metric, (double)bytes / BENCH_EVENTS, "bytes/event");
+  snprintf(metric, sizeof(metric), "flush_count.%s", name);
+  report(metric, (double)flushes / BENCH_EVENTS, "flushes/event");
+  snprintf(metric, sizeof(metric), "bus.%s", name);
+  report(metric, (double)busBytes / BENCH_EVENTS, "bytes/event");
+}
+
+static void benchEventSuite()
+{
+  static FramebufferDisplay display;
+  static HeroPageItem heroItem("Hero", onItemValue);
+  static HeroPage heroPage(icon_bulb);
+  static ListPage listPage(icon_settings);
+  static ListPage otherPage(icon_power);
+  static PageItem *items[BENCH_LIST_ITEMS];
+
+  Container &container = Container::create(display);
+  container.initDisplay();
+  container.addPage(listPage);
+  container.addPage(heroPage);
+  container.addPage(otherPage);
+  heroPage.addItem(heroItem);
+  for (int i = 0; i < BENCH_LIST_ITEMS; i++)
+  {
+    items[i] = new PageItem("Item", onItemValue);
+    listPage.addItem(*items[i]);
+  }
+  container.start();
+
+  // Navbar: step between pages.
+  const ROTARY_EVENT pageSwitch[] = {ROTARY_EVENT_CW, ROTARY_EVENT_CCW};
+  benchEvents("navbar_rotate", container, display, pageSwitch, 2);
+
+  // Enter the list page, then move the selection between the first two items.
+  sendEvent(container, ROTARY_EVENT_PUSH);
+  const ROTARY_EVENT itemSelect[] = {ROTARY_EVENT_CW, ROTARY_EVENT_CCW};
+  benchEvents("page_rotate", container, display, itemSelect, 2);
+
+  // Enter and leave item edit mode on the first item.
+  const ROTARY_EVENT itemPush[] = {ROTARY_EVENT_PUSH};
+  benchEvents("page_push", container, display, itemPush, 1);
+}
+
+// Applies one quadrature edge and returns the number of decoded detents that reached the callback queue.
+static size_t applyEdge(RotaryDebounce &rotary, int pinA, int pinB, unsigned long &ms)
+{
+  hostSetPin(BENCH_PIN_A, pinA);
+  hostSetPin(BENCH_PIN_B, pinB);
+  SimpleUIBench::abInterrupt(rotary, ms++);
+  return hostDrainQueues();
+}
+
+// Decode throughput of RotaryDebounce::abInterrupt under synthetic edge streams.
+static void benchRotaryDecode()
+{
+  RotaryDebounce rotary(BENCH_PIN_A, BENCH_PIN_B, (void (*)(const ROTARY_EVENT))nullptr);
+
+  // One clockwise detent: (A, B) from the HIGH/HIGH rest position.
+  const int cw[4][2] = {{LOW, HIGH}, {LOW, LOW}, {HIGH, LOW}, {HIGH, HIGH}};
+  struct Stream
+  {
+    const char *name;
+    int repeats; // interrupts per edge: contact bounce reads the settled level several times
+    bool noise;  // random pin levels instead of detents
+  } streams[] = {
+      {"clean", 1, false},
+      {"bouncy", 4, false},
+      {"noise", 1, true},
+  };
+
+  for (const Stream &stream : streams)
+  {
+    unsigned long ms = 0;
+    size_t events = 0;
+    size_t edges = 0;
+    u_int32_t lcg = 12345;
+    double start = nowNs();
+    while (edges < BENCH_EDGES)
+    {
+      for (int step = 0; step < 4; step++)
+      {
+        int pinA = cw[step][0];
+        int pinB = cw[step][1];
+        if (stream.noise)
+        {
+          lcg = lcg * 1103515245 + 12345;
+          pinA = (lcg >> 16) & 1;
+          pinB = (lcg >> 17) & 1;
+        }
+        for (int i = 0; i < stream.repeats; i++)
+        {
+          events += applyEdge(rotary, pinA, pinB, ms);
+          edges++;
+        }
+      }
+    }
+    double elapsed = nowNs() - start;
+
+    char metric[64];
+    snprintf(metric, sizeof(metric), "rotary_decode.%s", stream.name);
+    report(metric, elapsed / edges, "ns/edge");
+    snprintf(metric, sizeof(metric), "rotary_decode_rate.%s", stream.name);
+    report(metric, edges / (elapsed / 1e9), "edges/s");
+    snprintf(metric, sizeof(metric), "rotary_detents.%s", stream.name);
+    report(metric, (double)events * 4 * stream.repeats / edges, "detents/expected");
+  }
+}
+
+// Synthetic quadrature signal of an EC11 turned at a constant speed, for the accuracy benchmark.
+enum BOUNCE_SHAPE
+{
+  BOUNCE_NONE,
+  BOUNCE_UNIFORM,     // 0..maxBounces bounces spread over up to bounceUs
+  BOUNCE_EXPONENTIAL, // bounce duration drawn from an exponential distribution with mean bounceUs
+};
+
+struct BounceProfile
+{
+  const char *name;
+  BOUNCE_SHAPE shape;
+  u_int32_t bounceUs;
+  u_int8_t maxBounces;
+  u_int8_t jitterPercent; // random shift of each transition, in percent of the time between transitions
+  u_int32_t latencyUs;    // maximum delay from the edge to the pin read in the decode task
+};
+
+struct QuadratureEdge
+{
+  u_int32_t us;
+  u_int8_t pin; // 0 = A, 1 = B
+  u_int8_t level;
+  bool operator<(const QuadratureEdge &other) const { return us < other.us; }
+};
+
+struct BenchRandom
+{
+  u_int32_t state;
+  u_int32_t next()
+  {
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+  }
+  double uniform() { return (next() & 0xFFFFFF) / (double)0x1000000; } // [0, 1)
+};
+
+// Appends one contact transition to level at us, followed by the profile's bounce. A bounce never reaches
+// the next transition of the same contact, limitUs later.
+static void addTransition(std::vector<QuadratureEdge> &edges, const BounceProfile &profile, BenchRandom &random,
+                          u_int32_t us, u_int8_t pin, u_int8_t level, u_int32_t limitUs)
+{
+  edges.push_back({us, pin, level});
+  u_int32_t durationUs = 0;
+  u_int8_t bounces = 0;
+  if (profile.shape == BOUNCE_UNIFORM)
+  {
+    durationUs = profile.bounceUs * random.uniform();
+    bounces = random.next() % (profile.maxBounces + 1);
+  }
+  else if (profile.shape == BOUNCE_EXPONENTIAL)
+  {
+    durationUs = -log(1 - random.uniform()) * profile.bounceUs;
+    bounces = 1 + random.next() % profile.maxBounces;
+  }
+  durationUs = std::min(durationUs, limitUs * 9 / 10);
+  if (durationUs < 2 || bounces == 0)
+  {
+    return;
+  }
+  // Each bounce opens and closes the contact again: 2 edges at sorted offsets, ending at level.
+  std::vector<u_int32_t> offsets(2 * bounces);
+  for (u_int32_t &offset : offsets)
+  {
+    offset = 1 + random.next() % (durationUs - 1);
+  }
+  std::sort(offsets.begin(), offsets.end());
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    edges.push_back({us + offsets[i], pin, (u_int8_t)(i % 2 ? level : !level)});
+  }
+}
+
+// Turns of 1 to 20 detents in alternating directions. Transitions are evenly spaced over each detent, which
+// is how slow turning looks; fast flicks are faster within the detent, not slower.
+static void generateTurns(std::vector<QuadratureEdge> &edges, std::vector<ROTARY_EVENT> &detents, const BounceProfile &profile,
+                          BenchRandom &random, u_int32_t detentsPerSecond)
+{
+  // Levels of (A, B) after each transition, from the HIGH/HIGH rest position.
+  const u_int8_t cwPin[4] = {0, 1, 0, 1};
+  const u_int8_t ccwPin[4] = {1, 0, 1, 0};
+  const u_int8_t level[4] = {LOW, LOW, HIGH, HIGH};
+  u_int32_t quarterUs = 1000000 / detentsPerSecond / 4;
+  u_int32_t us = 1000000; // rest before the first turn
+  ROTARY_EVENT direction = ROTARY_EVENT_CW;
+  while (detents.size() < BENCH_DETENTS)
+  {
+    u_int32_t turn = 1 + random.next() % 20;
+    for (u_int32_t d = 0; d < turn && detents.size() < BENCH_DETENTS; d++)
+    {
+      for (int step = 0; step < 4; step++)
+      {
+        int32_t jitterUs = ((int32_t)(random.next() % 201) - 100) * (int32_t)quarterUs * profile.jitterPercent / 10000;
+        u_int32_t at = us + step * quarterUs + quarterUs / 2 + jitterUs;
+        addTransition(edges, profile, random, at, direction == ROTARY_EVENT_CW ? cwPin[step] : ccwPin[step], level[step], 2 * quarterUs);
+      }
+      detents.push_back(direction);
+      us += 4 * quarterUs;
+    }
+    direction = direction == ROTARY_EVENT_CW ? ROTARY_EVENT_CCW : ROTARY_EVENT_CW;
+    us += 200000; // pause between turns
+  }
+  std::stable_sort(edges.begin(), edges.end());
+}
+
+struct DecodeErrors
+{
+  size_t missed;    // detents that produced no event
+  size_t spurious;  // events without a detent
+  size_t direction; // events in the wrong direction
+};
+
+// Edit distance between the turned and the decoded detents: deletions are missed detents, insertions
+// spurious ones, substitutions direction errors.
+static DecodeErrors compareDetents(const std::vector<ROTARY_EVENT> &expected, const std::vector<ROTARY_EVENT> &decoded)
+{
+  struct Cell
+  {
+    size_t cost;
+    DecodeErrors errors;
+  };
+  std::vector<Cell> previous(decoded.size() + 1);
+  std::vector<Cell> current(decoded.size() + 1);
+  for (size_t j = 0; j <= decoded.size(); j++)
+  {
+    previous[j] = {j, {0, j, 0}};
+  }
+  for (size_t i = 1; i <= expected.size(); i++)
+  {
+    current[0] = {i, {i, 0, 0}};
+    for (size_t j = 1; j <= decoded.size(); j++)
+    {
+      Cell match = previous[j - 1];
+      if (expected[i - 1] != decoded[j - 1])
+      {
+        match.cost++;
+        match.errors.direction++;
+      }
+      Cell miss = previous[j];
+      miss.cost++;
+      miss.errors.missed++;
+      Cell extra = current[j - 1];
+      extra.cost++;
+      extra.errors.spurious++;
+      Cell best = match.cost <= miss.cost ? match : miss;
+      current[j] = best.cost <= extra.cost ? best : extra;
+    }
+    std::swap(previous, current);
+  }
+  return previous[decoded.size()].errors;
+}
+
+// Decoding accuracy of RotaryDebounce under contact bounce, timing jitter and ISR latency, versus speed.
+// Every edge is queued by the ISR at its time and read by the decode task after the latency, in order, as on
+// the device; edges arriving while the ISR queue is full are lost.
+static void benchRotaryAccuracy()
+{
+  const BounceProfile profiles[] = {
+      {"clean", BOUNCE_NONE, 0, 0, 0, 0},
+      {"bounce", BOUNCE_UNIFORM, 500, 4, 0, 0},
+      {"bounce_latency", BOUNCE_UNIFORM, 500, 4, 0, 200},
+      {"heavy_bounce", BOUNCE_EXPONENTIAL, 1500, 8, 0, 0},
+      {"jitter", BOUNCE_UNIFORM, 500, 4, 40, 0},
+      {"latency", BOUNCE_UNIFORM, 500, 4, 10, 2000},
+  };
+  const u_int32_t speeds[] = {1, 5, 20, 50, 100, 200}; // detents per second
+
+  for (const BounceProfile &profile : profiles)
+  {
+    for (u_int32_t speed : speeds)
+    {
+      BenchRandom random = {speed * 7919 + profile.bounceUs};
+      std::vector<QuadratureEdge> edges;
+      std::vector<ROTARY_EVENT> turned;
+      generateTurns(edges, turned, profile, random, speed);
+
+      RotaryDebounce rotary(BENCH_PIN_A, BENCH_PIN_B, (void (*)(const ROTARY_EVENT))nullptr);
+      std::vector<ROTARY_EVENT> decoded;
+      std::vector<u_int32_t> queued; // read times of the edges still in the ISR queue
+      u_int8_t levels[2] = {HIGH, HIGH};
+      size_t applied = 0;
+      u_int32_t readUs = 0;
+      for (const QuadratureEdge &edge : edges)
+      {
+        while (!queued.empty() && queued.front() <= edge.us)
+        {
+          queued.erase(queued.begin());
+        }
+        if (queued.size() >= BENCH_ISR_QUEUE_LENGTH)
+        {
+          continue; // dropped by the ISR
+        }
+        u_int32_t latencyUs = profile.latencyUs ? random.next() % profile.latencyUs : 0;
+        readUs = std::max(readUs + BENCH_ISR_SERVICE_US, edge.us + latencyUs);
+        queued.push_back(readUs);
+
+        // The decode task reads the pins as they are when it runs, not as they were at the edge.
+        while (applied < edges.size() && edges[applied].us <= readUs)
+        {
+          levels[edges[applied].pin] = edges[applied].level;
+          applied++;
+        }
+        hostSetPin(BENCH_PIN_A, levels[0]);
+        hostSetPin(BENCH_PIN_B, levels[1]);
+        ROTARY_EVENT direction;
+        bool completing = SimpleUIBench::completing(rotary, direction);
+        SimpleUIBench::abInterrupt(rotary, edge.us / 1000);
+        if (hostDrainQueues() > 0 && completing)
+        {
+          decoded.push_back(direction);
+        }
+      }
+
+      DecodeErrors errors = compareDetents(turned, decoded);
+      char metric[64];
+      snprintf(metric, sizeof(metric), "rotary_missed.%s.%udps", profile.name, (unsigned)speed);
+      report(metric, (double)errors.missed / turned.size(), "errors/detent");
+      snprintf(metric, sizeof(metric), "rotary_spurious.%s.%udps", profile.name, (unsigned)speed);
+      report(metric, (double)errors.spurious / turned.size(), "errors/detent");
+      snprintf(metric, sizeof(metric), "rotary_direction.%s.%udps", profile.name, (unsigned)speed);
+      report(metric, (double)errors.direction / turned.size(), "errors/detent");
+    }
+  }
+}
+
+// Navigation table check. The built-in page kinds are compared with a model of the per-page if/else handlers
+// the table replaced; every entry of every kind must resolve to an in-range outcome. Not a benchmark: a
+// mismatch is printed and fails the run.
+static bool navGuard(u_int8_t guardMask, u_int8_t guard)
+{
+  return guardMask & (1 << guard);
+}
+
+static NavOutcome navExpected(u_int8_t kind, u_int8_t context, u_int8_t input, u_int8_t guardMask)
+{
+  bool save = navGuard(guardMask, NAV_IF_SAVE_ACTIONS);
+  bool items = navGuard(guardMask, NAV_IF_ITEMS);
+  bool selected = navGuard(guardMask, NAV_IF_SELECTED);
+  bool itemSave = navGuard(guardMask, NAV_IF_ITEM_SAVE);
+  bool push = input == ROTARY_EVENT_PUSH;
+  switch (context)
+  {
+  case NONE: // the page was entered by a push from the navbar; turns are ignored
+    return {NAV_ALWAYS, NAV_NO_ACTION, (u_int8_t)(push ? PAGE : NONE)};
+  case NAVBAR:
+    if (push)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, PAGE};
+    }
+    return {NAV_ALWAYS, (u_int8_t)(input == ROTARY_EVENT_CW ? NAV_PAGE_NEXT : NAV_PAGE_PREVIOUS), NAVBAR};
+  case SAVE: // save actions disabled while selected: back to the navbar
+    if (!save)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR};
+    }
+    if (push)
+    {
+      return {NAV_ALWAYS, NAV_SAVE, NAVBAR};
+    }
+    return {NAV_ALWAYS, NAV_NO_ACTION, (u_int8_t)(input == ROTARY_EVENT_CW ? EXIT : PAGE)};
+  case EXIT:
+    if (!save)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR};
+    }
+    return {NAV_ALWAYS, (u_int8_t)(push ? NAV_EXIT : NAV_NO_ACTION), (u_int8_t)(push ? NAVBAR : SAVE)};
+  }
+
+  switch (kind)
+  {
+  case PAGE_NAVIGATION_LIST:
+    if (context == ITEM)
+    {
+      return {NAV_ALWAYS, (u_int8_t)(push ? NAV_NO_ACTION : NAV_ITEM_INPUT), (u_int8_t)(push ? PAGE : ITEM)};
+    }
+    if (push)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, (u_int8_t)(items ? ITEM : PAGE)};
+    }
+    if (selected)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, PAGE};
+    }
+    if (save)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, SAVE};
+    }
+    // Past the last item the navbar takes over; before the first one the selection stays.
+    return {NAV_ALWAYS, NAV_NO_ACTION, (u_int8_t)(input == ROTARY_EVENT_CW ? NAVBAR : PAGE)};
+  case PAGE_NAVIGATION_HERO: // the page context enters the item at once, so PAGE and ITEM behave alike
+    if (push)
+    {
+      return {NAV_ALWAYS, NAV_NO_ACTION, (u_int8_t)(itemSave ? SAVE : NAVBAR)};
+    }
+    return {NAV_ALWAYS, (u_int8_t)(items ? NAV_ITEM_INPUT : NAV_NO_ACTION), (u_int8_t)(items ? ITEM : NAVBAR)};
+  default: // PAGE_NAVIGATION_SCROLL; ITEM is not reachable and recovers to PAGE
+    return {NAV_ALWAYS, NAV_NO_ACTION, (u_int8_t)(context == PAGE && push ? NAVBAR : PAGE)};
+  }
+}
+
+static bool checkNavigation()
+{
+  size_t checked = 0;
+  size_t failures = 0;
+  for (u_int8_t kind = 0; kind < PAGE_NAVIGATION_COUNT; kind++)
+  {
+    for (u_int8_t context = 0; context < NAV_CONTEXT_COUNT; context++)
+    {
+      for (u_int8_t input = 0; input < NAV_INPUT_COUNT; input++)
+      {
+        for (u_int8_t guardMask = 0; guardMask < 1 << NAV_GUARD_COUNT; guardMask++)
+        {
+          // Guards that cannot hold together: a page with something to edit and save actions has both.
+          if (navGuard(guardMask, NAV_IF_ITEM_SAVE) !=
+              (navGuard(guardMask, NAV_IF_ITEMS) && navGuard(guardMask, NAV_IF_SAVE_ACTIONS)))
+          {
+            continue;
+          }
+          const NavOutcome &outcome = navigationResolve(kind, context, input, guardMask);
+          bool valid = outcome.guard < NAV_GUARD_COUNT && outcome.action < NAV_ACTION_COUNT && outcome.to < NAV_CONTEXT_COUNT;
+          bool expected = true;
+          if (kind == PAGE_NAVIGATION_CUSTOM)
+          {
+            expected = (context == PAGE || context == ITEM) == (outcome.action == NAV_CUSTOM);
+          }
+          else if (valid)
+          {
+            NavOutcome model = navExpected(kind, context, input, guardMask);
+            expected = outcome.action == model.action && outcome.to == model.to;
+          }
+          if (!valid || !expected)
+          {
+            fprintf(stderr, "navigation: kind %u context %u input %u guards 0x%02x -> action %u to %u\n", kind, context,
+                    input, guardMask, outcome.action, outcome.to);
+            failures++;
+          }
+          checked++;
+        }
+      }
+    }
+  }
+  report("navigation.transitions_checked", checked, "transitions");
+  report("navigation.mismatches", failures, "transitions");
+  return failures == 0;
+}
+
+// Adaptive switch debounce check. Presses and releases with a fixed bounce are fed through the ISR, and the
+// debounce timer fires whenever the pin stayed quiet for the window. After a learning phase the window must
+// hold at 1.5 times the bounce, within [minMs, maxMs], and report every press and release exactly once.
+struct SwitchProfile
+{
+  const char *name;
+  u_int32_t bounceUs; // the last bounce edge, exactly this long after each transition
+  u_int8_t bounces;
+  u_int32_t holdMs; // pressed, then released for as long
+  u_int16_t minMs;
+  u_int16_t maxMs;
+  u_int16_t settledMs;
+};
+
+struct SwitchRun
+{
+  SwitchDebounce &button;
+  unsigned long lastEdgeUs;
+  int reported;
+  size_t reports;
+  bool inRange;
+};
+
+static void onBenchSwitch(const u_int8_t pinState)
+{
+}
+
+// Fires the debounce timer if it expired before untilUs, and counts the state change it reports.
+static void expireSwitch(SwitchRun &run, unsigned long untilUs)
+{
+  TimerHandle_t timer = SimpleUIBench::debounceTimer(run.button);
+  unsigned long expiryUs = run.lastEdgeUs + run.button.debounceMs() * 1000UL;
+  if (!xTimerIsTimerActive(timer) || expiryUs > untilUs)
+  {
+    return;
+  }
+  hostAdvanceMicros(expiryUs - micros());
+  hostFireTimer(timer);
+  hostDrainQueues();
+  if (run.button.getPinState() != run.reported)
+  {
+    run.reported = run.button.getPinState();
+    run.reports++;
+  }
+}
+
+static void switchEdge(SwitchRun &run, const SwitchProfile &profile, unsigned long us, int level)
+{
+  expireSwitch(run, us);
+  hostAdvanceMicros(us - micros());
+  hostSetPin(BENCH_SWITCH_PIN, level);
+  switchDebounce_isr(&run.button);
+  run.lastEdgeUs = us;
+  u_int16_t windowMs = run.button.debounceMs();
+  run.inRange = run.inRange && windowMs >= profile.minMs && windowMs <= profile.maxMs;
+}
+
+// One transition to level at us and its bounce.
+static void switchTransition(SwitchRun &run, const SwitchProfile &profile, BenchRandom &random, unsigned long us, int level)
+{
+  switchEdge(run, profile, us, level);
+  if (profile.bounces == 0)
+  {
+    return;
+  }
+  std::vector<u_int32_t> offsets(2 * profile.bounces - 1);
+  for (u_int32_t &offset : offsets)
+  {
+    offset = 1 + random.next() % (profile.bounceUs - 1);
+  }
+  offsets.push_back(profile.bounceUs);
+  std::sort(offsets.begin(), offsets.end());
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    switchEdge(run, profile, us + offsets[i], i % 2 ? level : !level);
+  }
+}
+
+static bool checkAdaptiveDebounce()
+{
+  const SwitchProfile profiles[] = {
+      {"clean", 0, 0, 100, SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS, SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS, SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS},
+      {"bounce", 4000, 3, 100, SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS, SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS, 6},
+      {"worn", 25000, 6, 100, SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS, SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS, SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS},
+      // Taps shorter than maxMs: the press and the release are still measured apart.
+      {"tap", 1000, 2, 45, SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS, 100, 2},
+  };
+
+  size_t failures = 0;
+  for (const SwitchProfile &profile : profiles)
+  {
+    hostSetPin(BENCH_SWITCH_PIN, HIGH);
+    SwitchDebounce button(BENCH_SWITCH_PIN, onBenchSwitch);
+    button.start();
+    button.enableAdaptiveDebounce(profile.minMs, profile.maxMs);
+    SwitchRun run = {button, micros(), HIGH, 0, true};
+    BenchRandom random = {profile.bounceUs + 17};
+
+    SwitchDebounceStats learned;
+    u_int16_t lowestMs = 0xFFFF;
+    u_int16_t highestMs = 0;
+    for (int phase = 0; phase < 2; phase++)
+    {
+      button.getDebounceStats(learned);
+      size_t reports = run.reports;
+      for (int press = 0; press < BENCH_SWITCH_PRESSES; press++)
+      {
+        unsigned long us = micros() + profile.holdMs * 1000UL;
+        switchTransition(run, profile, random, us, LOW);
+        switchTransition(run, profile, random, us + profile.holdMs * 1000UL, HIGH);
+        expireSwitch(run, us + 2 * profile.holdMs * 1000UL);
+        if (phase == 1)
+        {
+          lowestMs = std::min(lowestMs, button.debounceMs());
+          highestMs = std::max(highestMs, button.debounceMs());
+        }
+      }
+      reports = run.reports - reports;
+      if (phase == 1 && reports != 2 * BENCH_SWITCH_PRESSES)
+      {
+        fprintf(stderr, "adaptive debounce %s: %u reports for %u presses\n", profile.name, (unsigned)reports, BENCH_SWITCH_PRESSES);
+        failures++;
+      }
+    }
+
+    SwitchDebounceStats stats;
+    button.getDebounceStats(stats);
+    bool settled = lowestMs == profile.settledMs && highestMs == profile.settledMs;
+    bool measured = stats.bursts + 1 == 4 * BENCH_SWITCH_PRESSES && stats.doubleFires == learned.doubleFires &&
+                    stats.maxBounceUs == profile.bounceUs;
+    if (!run.inRange || !settled || !measured)
+    {
+      fprintf(stderr, "adaptive debounce %s: window %u..%u ms (expected %u), %u bursts, %u double fires, max bounce %u us\n",
+              profile.name, lowestMs, highestMs, profile.settledMs, (unsigned)stats.bursts, (unsigned)stats.doubleFires,
+              (unsigned)stats.maxBounceUs);
+      failures++;
+    }
+
+    char metric[64];
+    snprintf(metric, sizeof(metric), "switch_window.%s", profile.name);
+    report(metric, stats.windowMs, "ms");
+    snprintf(metric, sizeof(metric), "switch_double_fires.%s", profile.name);
+    report(metric, stats.doubleFires, "reports");
+  }
+  report("switch_debounce.mismatches", failures, "profiles");
+  return failures == 0;
+}
+
+// Menu descriptor check. menu_data.h is menu.txt compiled by tools/menu_compile.py; load() must accept it
+// and reject damaged copies and firmware that cannot hold it, leaving the menu empty.
+static void onBenchMenu(u_int16_t item, int32_t value, void *arg)
+{
+}
+
+static bool checkMenuLoad(const char *name, DescriptorMenu &menu, const uint8_t *data, size_t size, MENU_DESCRIPTOR_ERROR expected)
+{
+  bool loaded = menu.load(data, size);
+  bool ok = loaded == (expected == MENU_DESCRIPTOR_OK) && menu.error() == expected &&
+            menu.itemCount() == (loaded ? BENCH_MENU_ITEMS : 0);
+  if (!ok)
+  {
+    fprintf(stderr, "menu descriptor %s: error %d, expected %d, %u items\n", name, menu.error(), expected,
+            (unsigned)menu.itemCount());
+  }
+  return ok;
+}
+
+static bool checkMenuDescriptor()
+{
+  const MenuCallback callbacks[BENCH_MENU_CALLBACKS] = {onBenchMenu, onBenchMenu};
+  int32_t values[BENCH_MENU_ITEMS];
+  size_t failures = 0;
+
+  DescriptorMenu menu(values, BENCH_MENU_ITEMS, callbacks, BENCH_MENU_CALLBACKS);
+  failures += !checkMenuLoad("good", menu, benchMenuData, sizeof(benchMenuData), MENU_DESCRIPTOR_OK);
+  if (menu.itemCount() == BENCH_MENU_ITEMS &&
+      (strcmp(menu.label(2), "Mode") != 0 || menu.value(0) != 10 || menu.value(2) != 1 || menu.pageCount() != 2))
+  {
+    fprintf(stderr, "menu descriptor good: content differs from menu.txt\n");
+    failures++;
+  }
+
+  alignas(4) uint8_t damaged[sizeof(benchMenuData)];
+  memcpy(damaged, benchMenuData, sizeof(damaged));
+  damaged[sizeof(damaged) - 8] ^= 0x01; // a string byte, below the CRC
+  failures += !checkMenuLoad("checksum", menu, damaged, sizeof(damaged), MENU_DESCRIPTOR_CHECKSUM);
+  failures += !checkMenuLoad("truncated", menu, benchMenuData, sizeof(benchMenuData) - 4, MENU_DESCRIPTOR_TRUNCATED);
+  // A rejected descriptor leaves nothing behind that blocks the next load.
+  failures += !checkMenuLoad("reload", menu, benchMenuData, sizeof(benchMenuData), MENU_DESCRIPTOR_OK);
+
+  DescriptorMenu small(values, BENCH_MENU_ITEMS - 1, callbacks, BENCH_MENU_CALLBACKS);
+  failures += !checkMenuLoad("capacity", small, benchMenuData, sizeof(benchMenuData), MENU_DESCRIPTOR_CAPACITY);
+  DescriptorMenu uncalled(values, BENCH_MENU_ITEMS);
+  failures += !checkMenuLoad("callbacks", uncalled, benchMenuData, sizeof(benchMenuData), MENU_DESCRIPTOR_ITEM);
+  DescriptorMenu fewer(values, BENCH_MENU_ITEMS, callbacks, BENCH_MENU_CALLBACKS - 1);
+  failures += !checkMenuLoad("callback_count", fewer, benchMenuData, sizeof(benchMenuData), MENU_DESCRIPTOR_ITEM);
+
+  report("menu_descriptor.bytes", sizeof(benchMenuData), "bytes");
+  report("menu_descriptor.mismatches", failures, "cases");
+  return failures == 0;
+}
+
+int main()
+{
+  if (!checkNavigation())
+  {
+    return 1;
+  }
+  if (!checkAdaptiveDebounce())
+  {
+    return 1;
+  }
+  if (!checkMenuDescriptor())
+  {
+    return 1;
+  }
+
+  static HeroPageItem heroItem("Hero", onItemValue);
+  static HeroPage heroPage(icon_bulb);
+  heroPage.addItem(heroItem);
+  benchDraw("hero_page", heroPage);
+
+  static ListPage listPage(icon_settings);
+  for (int i = 0; i < BENCH_LIST_ITEMS; i++)
+  {
+    listPage.addItem(*new PageItem("Item", onItemValue));
+  }
+  benchDraw("list_page", listPage);
+
+  static StaticListPage<StaticPageItem> staticListPage(icon_settings);
+  for (int i = 0; i < BENCH_LIST_ITEMS; i++)
+  {
+    staticListPage.addItem(*new StaticPageItem("Item", onStaticItemValue));
+  }
+  benchDraw("static_list_page", staticListPage);
+
+  static BenchListSource source;
+  static VirtualListPage virtualListPage(icon_settings, source);
+  benchDraw("virtual_list_page", virtualListPage);
+
+  static VirtualListPage uncachedListPage(icon_settings, source, 0);
+  benchDraw("virtual_list_page_uncached", uncachedListPage);
+
+  benchEventSuite();
+  benchRotaryDecode();
+  benchRotaryAccuracy();
+  return 0;
+}
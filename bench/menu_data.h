@@ -0,0 +1,22 @@
+// Generated by tools/menu_compile.py
+#include <stdint.h>
+
+alignas(4) const uint8_t benchMenuData[] = {
+    0x53, 0x55, 0x4d, 0x44, 0x00, 0x01, 0x28, 0x00, 0x10, 0x01, 0x00, 0x00, 0x02, 0x00, 0x05, 0x00,
+    0x00, 0x00, 0x08, 0x1c, 0x28, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0xc4, 0x00, 0x00, 0x00,
+    0xc4, 0x00, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x01,
+    0x07, 0x00, 0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0xff, 0xff, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x0a, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x18, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x22, 0x00, 0xff, 0xff, 0x27, 0x00, 0x01, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x38, 0x00, 0xff, 0xff,
+    0xff, 0xff, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0xfb, 0xff, 0xff, 0xff, 0x05, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0xfb, 0xff, 0xff, 0xff, 0x3e, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9f, 0x86, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x56, 0x6f, 0x6c, 0x75, 0x6d, 0x65, 0x00, 0x76, 0x6f, 0x6c, 0x75, 0x6d,
+    0x65, 0x00, 0x42, 0x61, 0x63, 0x6b, 0x6c, 0x69, 0x67, 0x68, 0x74, 0x00, 0x62, 0x61, 0x63, 0x6b,
+    0x6c, 0x69, 0x67, 0x68, 0x74, 0x00, 0x4d, 0x6f, 0x64, 0x65, 0x00, 0x45, 0x63, 0x6f, 0x00, 0x4e,
+    0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x00, 0x42, 0x6f, 0x6f, 0x73, 0x74, 0x00, 0x53, 0x70, 0x65, 0x65,
+    0x64, 0x00, 0x55, 0x70, 0x74, 0x69, 0x6d, 0x65, 0x00, 0x00, 0x00, 0x00, 0x45, 0x70, 0xb8, 0x62,
+};
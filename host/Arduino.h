@@ -0,0 +1,51 @@
+#ifndef Futojin_HOST_ARDUINO_H
+#define Futojin_HOST_ARDUINO_H
+
+// Minimal Arduino-ESP32 stand-in for building simpleUI on the host.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include "freertos.h"
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+#define digitalPinToInterrupt(p) (p)
+
+unsigned long millis();
+unsigned long micros();
+int digitalRead(uint8_t pin);
+void pinMode(uint8_t pin, uint8_t mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Host hooks, used by benchmarks to drive time and input pins.
+void hostSetMillis(unsigned long ms);
+void hostAdvanceMillis(unsigned long ms);
+void hostAdvanceMicros(unsigned long us);
+void hostSetPin(uint8_t pin, int state);
+
+class HardwareSerial
+{
+public:
+  void begin(unsigned long) {}
+  int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t write(const uint8_t *data, size_t len);
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+  uint32_t getFreeHeap();
+  uint32_t getCycleCount();
+};
+extern EspClass ESP;
+
+#endif // Futojin_HOST_ARDUINO_H
@@ -0,0 +1,328 @@
+#include "OLEDDisplay.h"
+#include <stdlib.h>
+
+OLEDDisplay::OLEDDisplay()
+    : buffer(nullptr),
+      buffer_back(nullptr),
+      hostBytesSent(0),
+      hostTransactions(0),
+      hostFlushes(0),
+      displayWidth(128),
+      displayHeight(64),
+      m_color(WHITE),
+      m_textAlignment(TEXT_ALIGN_LEFT),
+      m_fontData(ArialMT_Plain_10)
+{
+  setGeometry(GEOMETRY_128_64);
+}
+
+void OLEDDisplay::setGeometry(OLEDDISPLAY_GEOMETRY g, uint16_t width, uint16_t height)
+{
+  geometry = g;
+  displayWidth = 128;
+  displayHeight = 64;
+  switch (g)
+  {
+  case GEOMETRY_128_32:
+    displayHeight = 32;
+    break;
+  case GEOMETRY_64_48:
+    displayWidth = 64;
+    displayHeight = 48;
+    break;
+  case GEOMETRY_64_32:
+    displayWidth = 64;
+    displayHeight = 32;
+    break;
+  default:
+    break;
+  }
+  displayBufferSize = displayWidth * displayHeight / 8;
+}
+
+OLEDDisplay::~OLEDDisplay()
+{
+  end();
+}
+
+bool OLEDDisplay::init()
+{
+  if (!connect())
+  {
+    return false;
+  }
+  if (buffer == nullptr)
+  {
+    buffer = (uint8_t *)calloc(displayBufferSize, 1);
+    buffer_back = (uint8_t *)malloc(displayBufferSize);
+    memset(buffer_back, 0xFF, displayBufferSize); // force the first flush to send everything
+  }
+  resetDisplay();
+  return true;
+}
+
+void OLEDDisplay::end()
+{
+  free(buffer);
+  free(buffer_back);
+  buffer = nullptr;
+  buffer_back = nullptr;
+}
+
+void OLEDDisplay::resetDisplay()
+{
+  clear();
+}
+
+void OLEDDisplay::clear()
+{
+  if (buffer)
+  {
+    memset(buffer, 0, displayBufferSize);
+  }
+}
+
+void OLEDDisplay::setPixel(int16_t x, int16_t y)
+{
+  if (buffer == nullptr || x < 0 || x >= displayWidth || y < 0 || y >= displayHeight)
+  {
+    return;
+  }
+  uint8_t &cell = buffer[x + (y / 8) * displayWidth];
+  uint8_t mask = 1 << (y & 7);
+  switch (m_color)
+  {
+  case WHITE:
+    cell |= mask;
+    break;
+  case BLACK:
+    cell &= ~mask;
+    break;
+  case INVERSE:
+    cell ^= mask;
+    break;
+  }
+}
+
+void OLEDDisplay::clearPixel(int16_t x, int16_t y)
+{
+  OLEDDISPLAY_COLOR color = m_color;
+  m_color = BLACK;
+  setPixel(x, y);
+  m_color = color;
+}
+
+void OLEDDisplay::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+  int16_t dx = abs(x1 - x0);
+  int16_t dy = -abs(y1 - y0);
+  int16_t sx = x0 < x1 ? 1 : -1;
+  int16_t sy = y0 < y1 ? 1 : -1;
+  int16_t err = dx + dy;
+  for (;;)
+  {
+    setPixel(x0, y0);
+    if (x0 == x1 && y0 == y1)
+    {
+      break;
+    }
+    int16_t e2 = 2 * err;
+    if (e2 >= dy)
+    {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx)
+    {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void OLEDDisplay::drawHorizontalLine(int16_t x, int16_t y, int16_t length)
+{
+  for (int16_t i = 0; i < length; i++)
+  {
+    setPixel(x + i, y);
+  }
+}
+
+void OLEDDisplay::drawVerticalLine(int16_t x, int16_t y, int16_t length)
+{
+  for (int16_t i = 0; i < length; i++)
+  {
+    setPixel(x, y + i);
+  }
+}
+
+void OLEDDisplay::drawRect(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+  drawHorizontalLine(x, y, width);
+  drawVerticalLine(x, y, height);
+  drawVerticalLine(x + width - 1, y, height);
+  drawHorizontalLine(x, y + height - 1, width);
+}
+
+void OLEDDisplay::fillRect(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+  for (int16_t i = 0; i < width; i++)
+  {
+    drawVerticalLine(x + i, y, height);
+  }
+}
+
+void OLEDDisplay::drawXbm(int16_t x, int16_t y, int16_t width, int16_t height, const uint8_t *xbm)
+{
+  int16_t widthInXbm = (width + 7) / 8;
+  uint8_t data = 0;
+  for (int16_t j = 0; j < height; j++)
+  {
+    for (int16_t i = 0; i < width; i++)
+    {
+      if (i & 7)
+      {
+        data >>= 1;
+      }
+      else
+      {
+        data = pgm_read_byte(xbm + (i / 8) + j * widthInXbm);
+      }
+      if (data & 0x01)
+      {
+        setPixel(x + i, y + j);
+      }
+    }
+  }
+}
+
+uint8_t OLEDDisplay::glyphWidth(char c) const
+{
+  uint8_t height = pgm_read_byte(m_fontData + 1);
+  if (c == ' ' || c == '.' || c == ':' || c == 'i' || c == 'l')
+  {
+    return height / 4 + 1;
+  }
+  return height / 2 + 1;
+}
+
+void OLEDDisplay::drawGlyph(int16_t x, int16_t y, char c)
+{
+  uint8_t height = pgm_read_byte(m_fontData + 1);
+  uint8_t width = glyphWidth(c) - 1;
+  uint16_t pattern = (uint16_t)(c * 2654435761u >> 16);
+  for (uint8_t col = 0; col < width; col++)
+  {
+    for (uint8_t row = 1; row < height - 1; row++)
+    {
+      if ((pattern >> ((col + row) & 15)) & 1)
+      {
+        setPixel(x + col, y + row);
+      }
+    }
+  }
+}
+
+uint16_t OLEDDisplay::getStringWidth(const char *text)
+{
+  uint16_t width = 0;
+  for (const char *p = text; p && *p; p++)
+  {
+    width += glyphWidth(*p);
+  }
+  return width;
+}
+
+uint16_t OLEDDisplay::drawString(int16_t x, int16_t y, const char *text)
+{
+  if (text == nullptr)
+  {
+    return 0;
+  }
+  uint16_t width = getStringWidth(text);
+  switch (m_textAlignment)
+  {
+  case TEXT_ALIGN_CENTER_BOTH:
+    y -= pgm_read_byte(m_fontData + 1) / 2;
+    x -= width / 2;
+    break;
+  case TEXT_ALIGN_CENTER:
+    x -= width / 2;
+    break;
+  case TEXT_ALIGN_RIGHT:
+    x -= width;
+    break;
+  default:
+    break;
+  }
+  for (const char *p = text; *p; p++)
+  {
+    drawGlyph(x, y, *p);
+    x += glyphWidth(*p);
+  }
+  return width;
+}
+
+void OLEDDisplay::displayOn()
+{
+  sendCommand(0xAF);
+}
+
+void OLEDDisplay::displayOff()
+{
+  sendCommand(0xAE);
+}
+
+void OLEDDisplay::invertDisplay()
+{
+  sendCommand(0xA7);
+}
+
+void OLEDDisplay::normalDisplay()
+{
+  sendCommand(0xA6);
+}
+
+void OLEDDisplay::setContrast(uint8_t contrast, uint8_t precharge, uint8_t comdetect)
+{
+  sendCommand(0xD9);
+  sendCommand(precharge);
+  sendCommand(0x81);
+  sendCommand(contrast);
+  sendCommand(0xDB);
+  sendCommand(comdetect);
+}
+
+void OLEDDisplay::setBrightness(uint8_t brightness)
+{
+  uint8_t contrast = brightness;
+  if (brightness < 128)
+  {
+    contrast = brightness * 1.171;
+  }
+  else
+  {
+    contrast = brightness * 1.171 - 43;
+  }
+  uint8_t precharge = brightness == 0 ? 0 : 241;
+  uint8_t comdetect = brightness / 8;
+  setContrast(contrast, precharge, comdetect);
+}
+
+void OLEDDisplay::resetOrientation()
+{
+  sendCommand(0xA1);
+  sendCommand(0xC8);
+}
+
+void OLEDDisplay::flipScreenVertically()
+{
+  sendCommand(0xA0);
+  sendCommand(0xC0);
+}
+
+void OLEDDisplay::mirrorScreen()
+{
+  sendCommand(0xA0);
+  sendCommand(0xC8);
+}
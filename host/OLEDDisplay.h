@@ -0,0 +1,107 @@
+#ifndef Futojin_HOST_OLEDDISPLAY_H
+#define Futojin_HOST_OLEDDISPLAY_H
+
+// Host stand-in for the ThingPulse OLEDDisplay class. Only the subset of the API used by simpleUI is
+// provided. Drawing goes into a real page-organised frame buffer so rendering cost and flush traffic
+// are representative of the device.
+#include <Arduino.h>
+#include "OLEDDisplayFonts.h"
+
+#define OLEDDISPLAY_DOUBLE_BUFFER
+
+enum OLEDDISPLAY_COLOR
+{
+  BLACK = 0,
+  WHITE = 1,
+  INVERSE = 2
+};
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT
+{
+  TEXT_ALIGN_LEFT = 0,
+  TEXT_ALIGN_RIGHT = 1,
+  TEXT_ALIGN_CENTER = 2,
+  TEXT_ALIGN_CENTER_BOTH = 3
+};
+
+enum OLEDDISPLAY_GEOMETRY
+{
+  GEOMETRY_128_64 = 0,
+  GEOMETRY_128_32 = 1,
+  GEOMETRY_64_48 = 2,
+  GEOMETRY_64_32 = 3
+};
+
+enum HW_I2C
+{
+  I2C_ONE,
+  I2C_TWO
+};
+
+class OLEDDisplay
+{
+public:
+  OLEDDisplay();
+  virtual ~OLEDDisplay();
+
+  uint8_t *buffer;
+  uint8_t *buffer_back;
+
+  bool init();
+  void end();
+  void resetDisplay();
+  void clear();
+  virtual void display() = 0;
+
+  void setColor(OLEDDISPLAY_COLOR color) { m_color = color; }
+  OLEDDISPLAY_COLOR getColor() { return m_color; }
+  void setPixel(int16_t x, int16_t y);
+  void clearPixel(int16_t x, int16_t y);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+  void drawRect(int16_t x, int16_t y, int16_t width, int16_t height);
+  void fillRect(int16_t x, int16_t y, int16_t width, int16_t height);
+  void drawHorizontalLine(int16_t x, int16_t y, int16_t length);
+  void drawVerticalLine(int16_t x, int16_t y, int16_t length);
+  void drawXbm(int16_t x, int16_t y, int16_t width, int16_t height, const uint8_t *xbm);
+
+  uint16_t drawString(int16_t x, int16_t y, const char *text);
+  uint16_t getStringWidth(const char *text);
+  void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT textAlignment) { m_textAlignment = textAlignment; }
+  void setFont(const uint8_t *fontData) { m_fontData = fontData; }
+
+  void displayOn();
+  void displayOff();
+  void invertDisplay();
+  void normalDisplay();
+  void setContrast(uint8_t contrast, uint8_t precharge = 241, uint8_t comdetect = 64);
+  void setBrightness(uint8_t brightness);
+  void resetOrientation();
+  void flipScreenVertically();
+  void mirrorScreen();
+
+  uint16_t getWidth() const { return displayWidth; }
+  uint16_t getHeight() const { return displayHeight; }
+
+  // Host-only bus accounting, filled in by the transport subclasses.
+  uint32_t hostBytesSent;
+  uint32_t hostTransactions;
+  uint32_t hostFlushes;
+
+protected:
+  uint16_t displayWidth;
+  uint16_t displayHeight;
+  uint16_t displayBufferSize;
+  OLEDDISPLAY_GEOMETRY geometry;
+  OLEDDISPLAY_COLOR m_color;
+  OLEDDISPLAY_TEXT_ALIGNMENT m_textAlignment;
+  const uint8_t *m_fontData;
+
+  void setGeometry(OLEDDISPLAY_GEOMETRY g, uint16_t width = 0, uint16_t height = 0);
+  virtual int getBufferOffset() = 0;
+  virtual void sendCommand(uint8_t command) {}
+  virtual bool connect() { return false; }
+  uint8_t glyphWidth(char c) const;
+  void drawGlyph(int16_t x, int16_t y, char c);
+};
+
+#endif // Futojin_HOST_OLEDDISPLAY_H
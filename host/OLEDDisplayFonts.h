@@ -0,0 +1,13 @@
+#ifndef Futojin_HOST_OLEDDISPLAYFONTS_H
+#define Futojin_HOST_OLEDDISPLAYFONTS_H
+
+#include <pgmspace.h>
+#include <stdint.h>
+
+// Host stand-in fonts. Only the 4 byte header (width, height, first char, char count) of the
+// ThingPulse font format is provided; glyphs are synthesised by OLEDDisplay::drawGlyph.
+const uint8_t ArialMT_Plain_10[] PROGMEM = {0x0A, 0x0D, 0x20, 0xE0};
+const uint8_t ArialMT_Plain_16[] PROGMEM = {0x10, 0x13, 0x20, 0xE0};
+const uint8_t ArialMT_Plain_24[] PROGMEM = {0x18, 0x1C, 0x20, 0xE0};
+
+#endif // Futojin_HOST_OLEDDISPLAYFONTS_H
@@ -0,0 +1,59 @@
+#include "SH1106Wire.h"
+
+#define I2C_CHUNK_BYTES 16
+
+SH1106Wire::SH1106Wire(uint8_t address, int sda, int scl, OLEDDISPLAY_GEOMETRY g, HW_I2C i2cBus, int frequency)
+{
+  setGeometry(g);
+}
+
+void SH1106Wire::display()
+{
+  if (buffer == nullptr)
+  {
+    return;
+  }
+  hostFlushes++;
+
+  uint8_t minBoundY = UINT8_MAX;
+  uint8_t maxBoundY = 0;
+  uint8_t minBoundX = UINT8_MAX;
+  uint8_t maxBoundX = 0;
+  for (uint8_t y = 0; y < displayHeight / 8; y++)
+  {
+    for (uint8_t x = 0; x < displayWidth; x++)
+    {
+      uint16_t pos = x + y * displayWidth;
+      if (buffer[pos] != buffer_back[pos])
+      {
+        minBoundY = y < minBoundY ? y : minBoundY;
+        maxBoundY = y > maxBoundY ? y : maxBoundY;
+        minBoundX = x < minBoundX ? x : minBoundX;
+        maxBoundX = x > maxBoundX ? x : maxBoundX;
+      }
+      buffer_back[pos] = buffer[pos];
+    }
+  }
+
+  if (minBoundY == UINT8_MAX)
+  {
+    return;
+  }
+
+  uint8_t columns = maxBoundX - minBoundX + 1;
+  for (uint8_t y = minBoundY; y <= maxBoundY; y++)
+  {
+    sendCommand(0xB0 + y);
+    sendCommand(0x00);
+    sendCommand(0x10);
+    uint8_t chunks = (columns + I2C_CHUNK_BYTES - 1) / I2C_CHUNK_BYTES;
+    hostTransactions += chunks;
+    hostBytesSent += columns + chunks * 2; // address + 0x40 control byte per chunk
+  }
+}
+
+void SH1106Wire::sendCommand(uint8_t command)
+{
+  hostTransactions++;
+  hostBytesSent += 3; // address, 0x80 control byte, command
+}
@@ -0,0 +1,21 @@
+#ifndef Futojin_HOST_SH1106WIRE_H
+#define Futojin_HOST_SH1106WIRE_H
+
+#include "OLEDDisplay.h"
+
+// Host stand-in for the SH1106 I2C driver. display() walks the double buffer exactly like the
+// ThingPulse driver and accounts the I2C bytes and transactions it would have put on the bus.
+class SH1106Wire : public OLEDDisplay
+{
+public:
+  SH1106Wire(uint8_t address, int sda = -1, int scl = -1, OLEDDISPLAY_GEOMETRY g = GEOMETRY_128_64,
+             HW_I2C i2cBus = I2C_ONE, int frequency = 700000);
+  void display() override;
+
+protected:
+  int getBufferOffset() override { return 0; }
+  void sendCommand(uint8_t command) override;
+  bool connect() override { return true; }
+};
+
+#endif // Futojin_HOST_SH1106WIRE_H
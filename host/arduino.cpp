@@ -0,0 +1,92 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <chrono>
+
+#define HOST_PIN_COUNT 64
+
+static unsigned long long s_micros = 0;
+static int s_pins[HOST_PIN_COUNT];
+
+HardwareSerial Serial;
+EspClass ESP;
+
+unsigned long millis()
+{
+  return s_micros / 1000;
+}
+
+unsigned long micros()
+{
+  return s_micros;
+}
+
+void hostSetMillis(unsigned long ms)
+{
+  s_micros = ms * 1000ULL;
+}
+
+void hostAdvanceMillis(unsigned long ms)
+{
+  s_micros += ms * 1000ULL;
+}
+
+void hostAdvanceMicros(unsigned long us)
+{
+  s_micros += us;
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pin < HOST_PIN_COUNT ? s_pins[pin] : HIGH;
+}
+
+void hostSetPin(uint8_t pin, int state)
+{
+  if (pin < HOST_PIN_COUNT)
+  {
+    s_pins[pin] = state;
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin < HOST_PIN_COUNT && mode == INPUT_PULLUP)
+  {
+    s_pins[pin] = HIGH;
+  }
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode)
+{
+}
+
+void detachInterrupt(uint8_t pin)
+{
+}
+
+int HardwareSerial::printf(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int written = vfprintf(stderr, fmt, args);
+  va_end(args);
+  return written;
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t len)
+{
+  return fwrite(data, 1, len, stdout);
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+  return 200 * 1024;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  // Nanoseconds stand in for CPU cycles: deltas stay meaningful, absolute values do not.
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
@@ -0,0 +1,264 @@
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+struct HostTask
+{
+  TaskFunction_t fn;
+  uint32_t stackDepth;
+  uint32_t notifyValue;
+};
+
+struct HostQueue
+{
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+struct HostTimer
+{
+  TickType_t period;
+  bool autoReload;
+  bool active;
+  void *id;
+  TimerCallbackFunction_t callback;
+};
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param, UBaseType_t priority, TaskHandle_t *handle)
+{
+  HostTask *task = new HostTask{fn, stackDepth, 0};
+  if (handle)
+  {
+    *handle = task;
+  }
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  delete task;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  hostAdvanceMillis(ticks);
+}
+
+TickType_t xTaskGetTickCount()
+{
+  return (TickType_t)millis();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  return task ? task->stackDepth : 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  if (task)
+  {
+    task->notifyValue++;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, int action)
+{
+  if (task)
+  {
+    if (action == eSetBits)
+    {
+      task->notifyValue |= value;
+    }
+    else if (action == eIncrement)
+    {
+      task->notifyValue++;
+    }
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, int action, BaseType_t *woken)
+{
+  return xTaskNotify(task, value, action);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+  return 0;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value, TickType_t ticks)
+{
+  return pdFALSE;
+}
+
+static std::vector<HostQueue *> s_queues;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+  HostQueue *queue = new HostQueue{length, itemSize, {}};
+  s_queues.push_back(queue);
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+  if (queue == nullptr || queue->items.size() >= queue->length)
+  {
+    return pdFAIL;
+  }
+  const uint8_t *bytes = (const uint8_t *)item;
+  queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->itemSize));
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken)
+{
+  return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+  if (queue == nullptr || queue->items.empty())
+  {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+  return queue ? queue->items.size() : 0;
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t queue)
+{
+  return uxQueueMessagesWaiting(queue);
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+  return queue ? queue->length - queue->items.size() : 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  return new HostQueue{1, 0, {}};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+  return pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+  return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks)
+{
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+  delete sem;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *id, TimerCallbackFunction_t callback)
+{
+  return new HostTimer{period, autoReload != pdFALSE, false, id, callback};
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks)
+{
+  timer->active = true;
+  return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks)
+{
+  timer->active = false;
+  return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks)
+{
+  timer->active = true;
+  return pdPASS;
+}
+
+BaseType_t xTimerResetFromISR(TimerHandle_t timer, BaseType_t *woken)
+{
+  return xTimerReset(timer, 0);
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks)
+{
+  timer->period = period;
+  timer->active = true;
+  return pdPASS;
+}
+
+BaseType_t xTimerChangePeriodFromISR(TimerHandle_t timer, TickType_t period, BaseType_t *woken)
+{
+  return xTimerChangePeriod(timer, period, 0);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks)
+{
+  delete timer;
+  return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+  return timer && timer->active ? pdTRUE : pdFALSE;
+}
+
+TickType_t xTimerGetPeriod(TimerHandle_t timer)
+{
+  return timer->period;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer)
+{
+  return timer->id;
+}
+
+size_t hostDrainQueues()
+{
+  size_t drained = 0;
+  for (HostQueue *queue : s_queues)
+  {
+    drained += queue->items.size();
+    queue->items.clear();
+  }
+  return drained;
+}
+
+void hostFireTimer(TimerHandle_t timer)
+{
+  if (timer == nullptr || !timer->active)
+  {
+    return;
+  }
+  timer->active = timer->autoReload;
+  timer->callback(timer);
+}
@@ -0,0 +1,7 @@
+#ifndef Futojin_HOST_PGMSPACE_H
+#define Futojin_HOST_PGMSPACE_H
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+
+#endif // Futojin_HOST_PGMSPACE_H
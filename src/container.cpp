@@ -1,17 +1,20 @@
 #include "simpleUI.h"
+#include "itemRenderer.h"
 
 #define DRAW_MARGIN 2
 #define DRAW_SPACING 2
 #define MAX_DISPLAY_BRIGHTNESS 128
 #define MIN_DISPLAY_BRIGHTNESS 15
 #define MIN_SCREEN_SAVER_TIMEOUT_SEC 5
+#define RENDER_TASK_STACK_SIZE 4096
+#define PERF_OVERLAY_REFRESH_MS 1000
+#define PERF_OVERLAY_PADDING 2
 
 // Define static members
-Container::WatchdogTaskParams Container::s_watchdogTaskParams;
 Container *Container::s_containerInstance = nullptr;
 
 // Singleton factory methods
-Container &Container::getInstance(SH1106Wire &display)
+Container &Container::getInstance(SimpleUIDisplay &display)
 {
   if (s_containerInstance == nullptr)
   {
@@ -20,7 +23,7 @@ Container &Container::getInstance(SH1106Wire &display)
   return *s_containerInstance;
 }
 
-Container &Container::getInstance(SH1106Wire &display, u_int8_t tra, u_int8_t trb, u_int8_t psh)
+Container &Container::getInstance(SimpleUIDisplay &display, u_int8_t tra, u_int8_t trb, u_int8_t psh)
 {
   if (s_containerInstance == nullptr)
   {
@@ -29,38 +32,74 @@ Container &Container::getInstance(SH1106Wire &display, u_int8_t tra, u_int8_t tr
   return *s_containerInstance;
 }
 
-void onContainerRotaryEvent(ROTARY_EVENT rEvent);
-void onContainerSwitchEvent(u_int8_t pinState);
+Container &Container::create(SimpleUIDisplay &display)
+{
+  return *new Container(display);
+}
+
+Container &Container::create(SimpleUIDisplay &display, u_int8_t tra, u_int8_t trb, u_int8_t psh)
+{
+  return *new Container(display, tra, trb, psh);
+}
+
+void onContainerRotaryEvent(ROTARY_EVENT rEvent, void *arg);
+void onContainerSwitchEvent(u_int8_t pinState, void *arg);
 
-Container::Container(SH1106Wire &display)
+Container::Container(SimpleUIDisplay &display)
     : m_display(&display),
       m_currentPage(nullptr),
       m_navbar(display, *this),
       m_context(NAVBAR),
       m_idx(0),
-      m_watchdogTaskHandle(nullptr),
+      m_screenSaverTimer(nullptr),
       m_screenBrightness(MAX_DISPLAY_BRIGHTNESS), // Initialize to full brightness
       m_screenSaverTimeoutSec(0),                 // Initialize screen saver timeout to 0 (disabled)
-      m_lastActivityMs(millis())
+      m_lastActivityMs(millis()),
+      m_renderTaskHandle(nullptr),
+      m_stateMutex(xSemaphoreCreateRecursiveMutex()),
+      m_flipVertical(true),
+      m_prefetch(false),
+      m_drawRequests(0),
+      m_drawnRequests(0),
+      m_fpsWindowStartMs(millis()),
+      m_fpsWindowFrames(0),
+      m_transitionRequests(0),
+      m_transitionMs(0),
+      m_updatePending(false),
+      m_frameRestored(false),
+      m_mirror(nullptr)
 {
   m_rotaryDebounce = nullptr;
   m_switchDebounce = nullptr;
+  memset(&m_busStats, 0, sizeof(m_busStats));
+  memset(&m_perfOverlay, 0, sizeof(m_perfOverlay));
+  memset(&m_transitionHint, 0, sizeof(m_transitionHint));
 }
 
-Container::Container(SH1106Wire &display, u_int8_t tra, u_int8_t trb, u_int8_t psh)
+Container::Container(SimpleUIDisplay &display, u_int8_t tra, u_int8_t trb, u_int8_t psh)
     : Container(display)
 {
-  m_rotaryDebounce = new RotaryDebounce(tra, trb, onContainerRotaryEvent);
-  m_switchDebounce = new SwitchDebounce(psh, onContainerSwitchEvent);
+  m_rotaryDebounce = new RotaryDebounce(tra, trb, onContainerRotaryEvent, this);
+  m_switchDebounce = new SwitchDebounce(psh, onContainerSwitchEvent, this);
 }
 
 Container::~Container()
 {
-  // Clean up FreeRTOS task
-  if (m_watchdogTaskHandle)
+  // Clean up FreeRTOS task and timers
+  if (m_screenSaverTimer)
   {
-    vTaskDelete(m_watchdogTaskHandle);
-    m_watchdogTaskHandle = nullptr;
+    xTimerDelete(m_screenSaverTimer, 0);
+    m_screenSaverTimer = nullptr;
+  }
+  if (m_renderTaskHandle)
+  {
+    vTaskDelete(m_renderTaskHandle);
+    m_renderTaskHandle = nullptr;
+  }
+  if (m_perfOverlay.refreshTimer)
+  {
+    xTimerDelete(m_perfOverlay.refreshTimer, 0);
+    m_perfOverlay.refreshTimer = nullptr;
   }
 
   // Clean up heap-allocated objects
@@ -75,26 +114,91 @@ Container::~Container()
     delete m_switchDebounce;
     m_switchDebounce = nullptr;
   }
+
+  vSemaphoreDelete(m_stateMutex);
 }
 
-void onContainerRotaryEvent(ROTARY_EVENT rEvent)
+void onContainerRotaryEvent(ROTARY_EVENT rEvent, void *arg)
 {
   Event event;
   event.eventId = EVENT_ROT;
   event.value = rEvent;
-  DEBUG_SIMPLEUI("Got Rotary Event: %s\n", (rEvent == ROTARY_EVENT_CW) ? "CW" : "CCW");
-  Container::s_containerInstance->onEvent(event);
+  ((Container *)arg)->onEvent(event);
 }
 
-void onContainerSwitchEvent(u_int8_t pinState)
+void onContainerSwitchEvent(u_int8_t pinState, void *arg)
 {
+  Container *container = (Container *)arg;
   if (pinState == LOW)
   {
+    container->m_perfOverlay.pushStartMs = millis();
     Event event;
     event.eventId = EVENT_ROT;
     event.value = ROTARY_EVENT_PUSH;
-    DEBUG_SIMPLEUI("Got Push Event: %s\n", (pinState == HIGH) ? "HIGH" : "LOW");
-    Container::s_containerInstance->onEvent(event);
+    container->onEvent(event);
+  }
+  else if (container->m_perfOverlay.gesture && millis() - container->m_perfOverlay.pushStartMs >= PERF_OVERLAY_HOLD_MS)
+  {
+    container->enablePerfOverlay(!container->m_perfOverlay.enabled);
+  }
+}
+
+void onContainerPerfOverlayTimer(TimerHandle_t timer)
+{
+  Container *container = (Container *)pvTimerGetTimerID(timer);
+  if (container->m_perfOverlay.enabled && container->m_screenBrightness > MIN_DISPLAY_BRIGHTNESS)
+  {
+    container->requestDraw(Container::RENDER_OVERLAY);
+  }
+}
+
+// Runs in the timer service task, timeoutSec after the last event.
+void onContainerScreenSaverTimer(TimerHandle_t timer)
+{
+  Container *container = (Container *)pvTimerGetTimerID(timer);
+  u_int32_t timeoutMs = container->m_screenSaverTimeoutSec * 1000;
+  if (timeoutMs == 0)
+  {
+    return;
+  }
+  // Ticks and millis() are not in phase, so the timer can expire up to a tick early; an event racing the
+  // expiry, or a restart dropped on a full timer queue, leaves it early too. Wait for the rest of the timeout.
+  u_int32_t elapsed = millis() - container->m_lastActivityMs;
+  if (elapsed < timeoutMs)
+  {
+    xTimerChangePeriod(timer, pdMS_TO_TICKS(timeoutMs - elapsed) + 1, 0);
+    return;
+  }
+  if (container->m_screenBrightness > MIN_DISPLAY_BRIGHTNESS)
+  {
+    container->m_screenBrightness = MIN_DISPLAY_BRIGHTNESS;
+    container->requestDraw(Container::RENDER_FRAME | Container::RENDER_BRIGHTNESS | Container::RENDER_CAUSE_SCREENSAVER);
+  }
+}
+
+// Each container flushes its own display from its own task, so a slow bus never stalls input handling or
+// another container's panel. Requests are notification bits: several events arriving during one flush
+// collapse into a single frame. While a transition runs, the task wakes up for its next step unless a new
+// request comes first.
+void onContainerRenderTask(void *parameter)
+{
+  Container *container = (Container *)parameter;
+  for (;;)
+  {
+    TickType_t wait = portMAX_DELAY;
+    if (container->m_transition.active())
+    {
+      wait = pdMS_TO_TICKS(container->m_transition.nextStepMs(millis()));
+    }
+    uint32_t requests = 0;
+    if (xTaskNotifyWait(0, UINT32_MAX, &requests, wait) == pdTRUE)
+    {
+      container->draw(requests);
+    }
+    else
+    {
+      container->drawTransitionStep();
+    }
   }
 }
 
@@ -112,8 +216,9 @@ void Container::addPage(Page &childPage)
 {
   childPage.m_display = this->m_display;
   childPage.syncDisplay();
+  childPage.m_position = m_pages.size();
   m_pages.push_back(&childPage);
-  m_navbar.addPage(childPage);
+  m_enabledPages.push_back(childPage.enabled());
   childPage.m_container = this;
 
   if (m_currentPage == nullptr) // If this is the first page, assume current
@@ -126,30 +231,586 @@ void Container::addPage(Page &childPage)
 void Container::setCurrentPage(Page &newPage)
 {
   // Check if the mainPage is in m_pages vector
-  for (size_t i = 0; i < m_pages.size(); i++)
+  if (newPage.m_container == this && newPage.m_position < m_pages.size())
   {
-    Page *page = m_pages[i];
-    if (page == &newPage)
+    lockState();
+    m_currentPage = &newPage;
+    m_idx = newPage.m_position;
+    unlockState();
+  }
+  // Page not found in m_pages, do nothing.
+}
+
+void Container::requestDraw(u_int32_t requests)
+{
+  __atomic_fetch_add(&m_drawRequests, 1, __ATOMIC_RELAXED); // called from several tasks
+  if (m_renderTaskHandle)
+  {
+    xTaskNotify(m_renderTaskHandle, requests, eSetBits);
+    return;
+  }
+  draw(requests); // not started yet, or SIMPLEUI_SYNC_RENDER
+}
+
+// Estimates the bus traffic of the next display() call from the same dirty rectangle the driver computes.
+// Returns false if no pixel changed, in which case the driver sends nothing.
+static bool estimateFlush(SimpleUIDisplay *display, u_int32_t &bytes, u_int32_t &transactions)
+{
+  u_int16_t width = display->getWidth();
+  u_int16_t pages = display->getHeight() / 8;
+  u_int16_t minX = UINT16_MAX;
+  u_int16_t maxX = 0;
+  u_int16_t minPage = UINT16_MAX;
+  u_int16_t maxPage = 0;
+#ifdef OLEDDISPLAY_DOUBLE_BUFFER
+  for (u_int16_t page = 0; page < pages; page++)
+  {
+    const uint8_t *row = display->buffer + page * width;
+    const uint8_t *rowBack = display->buffer_back + page * width;
+    if (memcmp(row, rowBack, width) == 0)
     {
-      m_currentPage = &newPage;
-      m_idx = i;
-      return;
+      continue;
+    }
+    minPage = page < minPage ? page : minPage;
+    maxPage = page;
+    for (u_int16_t x = 0; x < width; x++)
+    {
+      if (row[x] != rowBack[x])
+      {
+        minX = x < minX ? x : minX;
+        maxX = x > maxX ? x : maxX;
+      }
     }
   }
-  // Page not found in m_pages, do nothing.
+#else
+  minX = 0; // without a back buffer the driver sends the whole frame
+  maxX = width - 1;
+  minPage = 0;
+  maxPage = pages - 1;
+#endif
+  if (minPage == UINT16_MAX)
+  {
+    return false;
+  }
+
+  u_int32_t columns = maxX - minX + 1;
+  u_int32_t rows = maxPage - minPage + 1;
+  u_int32_t chunks = SIMPLEUI_BUS_CHUNK_BYTES ? (columns + SIMPLEUI_BUS_CHUNK_BYTES - 1) / SIMPLEUI_BUS_CHUNK_BYTES : 1;
+  u_int32_t commands = SIMPLEUI_BUS_FLUSH_COMMANDS + rows * SIMPLEUI_BUS_PAGE_COMMANDS;
+  bytes += commands * SIMPLEUI_BUS_COMMAND_BYTES + rows * (columns + chunks * SIMPLEUI_BUS_CHUNK_OVERHEAD);
+  transactions += commands + rows * chunks;
+  return true;
 }
 
-void Container::draw()
+void Container::draw(u_int32_t requests)
 {
-  DEBUG_SIMPLEUI("Container::draw\n");
-  m_display->clear();
-  drawOverlay();
-  m_navbar.draw(*m_currentPage);
-  if (m_currentPage)
+  SIMPLEUI_TRACE(TRACE_DRAW, requests);
+  unsigned long drawStartUs = micros();
+  u_int32_t commands = 0;
+  lockState();
+  if (requests & RENDER_ORIENTATION)
+  {
+    commands += 2; // segment remap and COM scan direction
+    if (m_flipVertical)
+    {
+      m_display->flipScreenVertically();
+    }
+    else
+    {
+      m_display->resetOrientation();
+    }
+  }
+  if (requests & RENDER_BRIGHTNESS)
   {
-    m_currentPage->draw();
+    commands += 6; // precharge, contrast and VCOMH detect, each with its argument
+    m_display->setBrightness(m_screenBrightness);
   }
+
+  bool dimmed = m_screenBrightness <= MIN_DISPLAY_BRIGHTNESS;
+  if (requests & RENDER_OVERLAY)
+  {
+    updatePerfOverlay();
+  }
+  if ((requests & RENDER_UPDATE) && !(requests & RENDER_FRAME))
+  {
+    if (m_transition.active())
+    {
+      m_updatePending = true; // drawn on top of the last step
+      requests &= ~RENDER_UPDATE;
+    }
+    else if (m_perfOverlay.enabled)
+    {
+      requests |= RENDER_FRAME; // the overlay would be moved along with the content
+    }
+  }
+  // A new frame ends a running transition; it starts another one from whatever is on screen if the events it
+  // serves can be animated.
+  bool animate = false;
+  TransitionHint hint = m_transitionHint;
+  if (requests & RENDER_FRAME)
+  {
+    m_transitionHint.kind = TRANSITION_NONE;
+    animate = m_transitionMs > 0 && m_renderTaskHandle && !dimmed && hint.kind > TRANSITION_CUT &&
+              m_transition.capture(m_display->buffer, m_display->getWidth(), m_display->getHeight());
+    m_transition.cancel();
+  }
+  if ((requests & RENDER_UPDATE) && !(requests & RENDER_FRAME) && !dimmed && m_currentPage)
+  {
+    m_currentPage->drawUpdate();
+  }
+  if (requests & RENDER_FRAME)
+  {
+    m_updatePending = false;
+    m_display->clear();
+    drawOverlay();
+    if (!dimmed) // Screen saver only keeps the overlay
+    {
+      m_navbar.draw();
+      if (m_currentPage)
+      {
+        m_currentPage->draw();
+      }
+    }
+  }
+  if (animate)
+  {
+    // The first step replaces the finished frame in the buffer.
+    m_transitionRequests = requests & ~(RENDER_BRIGHTNESS | RENDER_ORIENTATION);
+    m_transition.begin(hint, m_display->buffer, millis(), m_transitionMs);
+    if (m_perfOverlay.enabled)
+    {
+      m_transition.exclude(perfOverlayRect()); // drawn on top of every step instead of moving with it
+    }
+    m_transition.step(m_display->buffer, millis());
+    SIMPLEUI_TRACE(TRACE_TRANSITION, m_transition.kind(), m_transition.frames(), m_transition.droppedFrames());
+  }
+  // An overlay-only request redraws the box on top of the previous frame, so only its corner is flushed.
+  if (m_perfOverlay.enabled && !dimmed)
+  {
+    drawPerfOverlay();
+    if (m_transition.active())
+    {
+      m_transition.exclude(perfOverlayRect()); // the box may have grown
+    }
+  }
+  // Without the render task (SIMPLEUI_SYNC_RENDER, or before start()), draw() runs in whichever task asked
+  // for the frame, so another one could rebuild the frame buffer during the flush: keep the lock across it.
+  bool direct = m_renderTaskHandle == nullptr;
+  if (!direct)
+  {
+    unlockState();
+  }
+
+  u_int32_t bytes = flush(requests, commands);
+  if (direct)
+  {
+    unlockState();
+  }
+  if (requests & RENDER_FRAME)
+  {
+    m_perfOverlay.frameUs = micros() - drawStartUs;
+    m_perfOverlay.frameBytes = bytes;
+  }
+
+  if (m_prefetch)
+  {
+    prefetchNeighbours();
+  }
+}
+
+// Composes and flushes the next step of the running transition. Returns false after the last one.
+bool Container::drawTransitionStep()
+{
+  lockState();
+  bool more = m_transition.step(m_display->buffer, millis());
+  if (m_perfOverlay.enabled && m_screenBrightness > MIN_DISPLAY_BRIGHTNESS)
+  {
+    drawPerfOverlay();
+  }
+  unlockState();
+  SIMPLEUI_TRACE(TRACE_TRANSITION, m_transition.kind(), m_transition.frames(), m_transition.droppedFrames());
+
+  flush(m_transitionRequests, 0);
+  if (!more && m_updatePending)
+  {
+    m_updatePending = false;
+    requestDraw(RENDER_UPDATE);
+  }
+  return more;
+}
+
+// Sends the frame buffer and accounts for it. Returns the estimated bus bytes.
+u_int32_t Container::flush(u_int32_t requests, u_int32_t commands)
+{
+  u_int32_t bytes = commands * SIMPLEUI_BUS_COMMAND_BYTES;
+  u_int32_t transactions = commands;
+  bool changed = estimateFlush(m_display, bytes, transactions);
+
+  // Only the render task draws into the frame buffer, so it can be flushed without holding the state lock;
+  // draw() keeps the lock when there is no render task.
+  unsigned long flushStartUs = micros();
   m_display->display();
+  u_int32_t flushUs = micros() - flushStartUs;
+  SIMPLEUI_TRACE(TRACE_FLUSH, bytes, transactions, flushUs);
+  accountFlush(requests, changed, flushUs, bytes, transactions);
+  if (m_mirror)
+  {
+    m_mirror->onFrame(m_display->buffer, m_display->getWidth(), m_display->getHeight()); // unchanged pages cost nothing
+  }
+  return bytes;
+}
+
+void Container::accountFlush(u_int32_t requests, bool changed, u_int32_t flushUs, u_int32_t bytes, u_int32_t transactions)
+{
+  DRAW_CAUSE cause = DRAW_CAUSE_EXTERNAL;
+  if (requests & RENDER_CAUSE_ROTARY)
+  {
+    cause = DRAW_CAUSE_ROTARY;
+  }
+  else if (requests & RENDER_CAUSE_PUSH)
+  {
+    cause = DRAW_CAUSE_PUSH;
+  }
+  else if (requests & RENDER_CAUSE_SCREENSAVER)
+  {
+    cause = DRAW_CAUSE_SCREENSAVER;
+  }
+
+  // Runs on the render task outside the drawing lock; getBusStats() and resetBusStats() take the same lock.
+  lockState();
+  // Every request since the previous frame was served by this one.
+  u_int32_t drawRequests = __atomic_load_n(&m_drawRequests, __ATOMIC_RELAXED);
+  if (requests == RENDER_OVERLAY)
+  {
+    // The overlay's own refresh: counting it would add a frame a second and its bytes to the measurement.
+    m_drawnRequests = drawRequests;
+    unlockState();
+    return;
+  }
+  BusCauseStats *targets[] = {&m_busStats.causes[cause], &m_busStats.total};
+  for (BusCauseStats *target : targets)
+  {
+    target->frames++;
+    target->emptyFrames += changed ? 0 : 1;
+    target->bytes += bytes;
+    target->transactions += transactions;
+    target->flushUs += flushUs;
+    target->maxFlushUs = flushUs > target->maxFlushUs ? flushUs : target->maxFlushUs;
+  }
+
+  if (drawRequests - m_drawnRequests > 1)
+  {
+    m_busStats.skippedFrames += drawRequests - m_drawnRequests - 1;
+  }
+  m_drawnRequests = drawRequests;
+
+  unsigned long nowMs = millis();
+  m_fpsWindowFrames++;
+  if (nowMs - m_fpsWindowStartMs >= 1000)
+  {
+    m_busStats.fps = m_fpsWindowFrames;
+    m_fpsWindowFrames = 0;
+    m_fpsWindowStartMs = nowMs;
+  }
+  unlockState();
+}
+
+void Container::enableAdaptiveDebounce(u_int16_t minMs, u_int16_t maxMs)
+{
+  if (m_switchDebounce)
+  {
+    m_switchDebounce->enableAdaptiveDebounce(minMs, maxMs);
+  }
+}
+
+void Container::getSwitchStats(SwitchDebounceStats &stats) const
+{
+  memset(&stats, 0, sizeof(stats));
+  if (m_switchDebounce)
+  {
+    m_switchDebounce->getDebounceStats(stats);
+  }
+}
+
+void Container::getBusStats(BusStats &stats) const
+{
+  lockState();
+  stats = m_busStats;
+  if (millis() - m_fpsWindowStartMs >= 2000)
+  {
+    stats.fps = 0; // nothing drawn for more than a second
+  }
+  unlockState();
+}
+
+void Container::resetBusStats()
+{
+  lockState();
+  memset(&m_busStats, 0, sizeof(m_busStats));
+  m_drawnRequests = __atomic_load_n(&m_drawRequests, __ATOMIC_RELAXED);
+  m_fpsWindowStartMs = millis();
+  m_fpsWindowFrames = 0;
+  unlockState();
+}
+
+void Container::setMirror(FrameMirror *mirror)
+{
+  if (mirror)
+  {
+    mirror->requestKeyframe();
+  }
+  m_mirror = mirror; // read by flush() only, on the render task
+}
+
+void Container::enablePerfOverlay(bool enabled)
+{
+  if (m_perfOverlay.refreshTimer == nullptr)
+  {
+    m_perfOverlay.refreshTimer = xTimerCreate("Perf Overlay", pdMS_TO_TICKS(PERF_OVERLAY_REFRESH_MS), pdTRUE, this, onContainerPerfOverlayTimer);
+  }
+
+  lockState();
+  m_perfOverlay.enabled = enabled;
+  m_perfOverlay.width = 0;
+  unlockState();
+
+  if (enabled)
+  {
+    xTimerStart(m_perfOverlay.refreshTimer, 0);
+    requestDraw(RENDER_FRAME | RENDER_OVERLAY);
+  }
+  else
+  {
+    xTimerStop(m_perfOverlay.refreshTimer, 0);
+    requestDraw(); // redraw what the box covered
+  }
+}
+
+void Container::updatePerfOverlay()
+{
+  ResourceStats stats;
+  memset(&stats, 0, sizeof(stats));
+  if (m_rotaryDebounce)
+  {
+    RotaryDebounce::getResourceStats(stats);
+  }
+  if (m_switchDebounce)
+  {
+    m_switchDebounce->getResourceStats(stats);
+  }
+  unsigned long dropped = 0;
+  for (const QueueStats &queue : stats.queues)
+  {
+    dropped += queue.dropped;
+  }
+
+  BusStats bus;
+  getBusStats(bus);
+  // Clamped so both lines always fit PERF_OVERLAY_LINE_SIZE: "999.9ms 65535fps", "99999B d9999 9999k".
+  unsigned frameUs = m_perfOverlay.frameUs < 999999 ? m_perfOverlay.frameUs : 999999;
+  unsigned frameBytes = m_perfOverlay.frameBytes < 99999 ? m_perfOverlay.frameBytes : 99999;
+  unsigned droppedEvents = dropped < 9999 ? dropped : 9999;
+  unsigned long freeHeapK = ESP.getFreeHeap() / 1024;
+  unsigned heapK = freeHeapK < 9999 ? freeHeapK : 9999;
+  snprintf(m_perfOverlay.lines[0], PERF_OVERLAY_LINE_SIZE, "%u.%ums %ufps", frameUs / 1000, frameUs / 100 % 10, (unsigned)bus.fps);
+  snprintf(m_perfOverlay.lines[1], PERF_OVERLAY_LINE_SIZE, "%uB d%u %uk", frameBytes, droppedEvents, heapK);
+}
+
+void Container::drawPerfOverlay()
+{
+  m_display->setFont(font_perf_overlay);
+  m_display->setTextAlignment(TEXT_ALIGN_LEFT);
+
+  // The box only grows while the overlay is on, so a refresh always covers the previous text.
+  for (const char *line : m_perfOverlay.lines)
+  {
+    u_int16_t width = m_display->getStringWidth(line) + 2 * PERF_OVERLAY_PADDING;
+    m_perfOverlay.width = width > m_perfOverlay.width ? width : m_perfOverlay.width;
+  }
+  TransitionRect box = perfOverlayRect();
+
+  m_display->setColor(BLACK);
+  m_display->fillRect(box.x, box.y, box.w - 1, box.h - 1);
+  m_display->setColor(WHITE);
+  m_display->drawRect(box.x, box.y, box.w, box.h);
+  m_display->drawString(box.x + PERF_OVERLAY_PADDING, box.y, m_perfOverlay.lines[0]);
+  m_display->drawString(box.x + PERF_OVERLAY_PADDING, box.y + PAGE_ITEM_DRAW_HEIGHT, m_perfOverlay.lines[1]);
+}
+
+// Box of the overlay, border included.
+TransitionRect Container::perfOverlayRect() const
+{
+  int16_t height = 2 * PAGE_ITEM_DRAW_HEIGHT + PERF_OVERLAY_PADDING;
+  TransitionRect box = {(int16_t)(m_display->getWidth() - 1 - m_perfOverlay.width), (int16_t)(m_display->getHeight() - 1 - height),
+                        (int16_t)(m_perfOverlay.width + 1), (int16_t)(height + 1)};
+  return box;
+}
+
+void Container::enableTransitions(bool enabled, u_int16_t durationMs)
+{
+  lockState();
+  m_transitionMs = enabled ? durationMs : 0;
+  m_transitionHint.kind = TRANSITION_NONE;
+  unlockState();
+}
+
+// Page content moves inside the border, above the navbar.
+TransitionRect Container::pageArea() const
+{
+  TransitionRect area = {1, 1, (int16_t)(m_display->getWidth() - 2), (int16_t)(m_display->getHeight() - ICON_SIZE - 2)};
+  return area;
+}
+
+void Container::transitionState(TransitionState &state) const
+{
+  state.idx = m_idx;
+  state.navbar = m_navbar.highlightRect(state.navbarHighlight);
+  state.page = m_currentPage && m_currentPage->selection(state.selection);
+  state.saveAction = m_currentPage && m_currentPage->saveActionHighlight(state.saveActionHighlight);
+}
+
+bool Container::TransitionState::highlight(TransitionRect &rect) const
+{
+  if (navbar)
+  {
+    rect = navbarHighlight;
+  }
+  else if (page)
+  {
+    rect = selection.highlight;
+  }
+  else if (saveAction)
+  {
+    rect = saveActionHighlight;
+  }
+  return navbar || page || saveAction;
+}
+
+// Compares the state before an event with the current one. Page switches slide the page area, list pages
+// scroll their rows or move their highlight, and so do context changes between the navbar, list rows and save
+// actions. Everything else is a cut, including editing a value: items draw their own value outline.
+void Container::noteTransition(const TransitionState &before)
+{
+  TransitionState after;
+  transitionState(after);
+
+  TransitionHint hint;
+  memset(&hint, 0, sizeof(hint));
+  hint.kind = TRANSITION_CUT;
+  if (after.idx != before.idx && before.navbar && after.navbar)
+  {
+    hint.kind = TRANSITION_SLIDE;
+    hint.region = pageArea();
+    hint.distance = after.idx > before.idx ? hint.region.w : -hint.region.w; // the next page comes from the right
+    hint.highlight = true;
+    hint.fromHighlight = before.navbarHighlight;
+    hint.toHighlight = after.navbarHighlight;
+  }
+  else if (after.idx == before.idx && before.page && after.page)
+  {
+    int32_t distance = after.selection.scrollY - before.selection.scrollY;
+    const TransitionRect &from = before.selection.highlight;
+    const TransitionRect &to = after.selection.highlight;
+    bool moved = from.x != to.x || from.y != to.y || from.w != to.w || from.h != to.h;
+    hint.region = after.selection.viewport;
+    hint.distance = distance;
+    hint.highlight = true;
+    hint.fromHighlight = from;
+    hint.toHighlight = to;
+    if (distance != 0 && distance < hint.region.h && -distance < hint.region.h)
+    {
+      hint.kind = TRANSITION_SCROLL;
+    }
+    else if (distance == 0 && moved)
+    {
+      hint.kind = TRANSITION_MOVE;
+    }
+  }
+  else if (after.idx == before.idx && before.highlight(hint.fromHighlight) && after.highlight(hint.toHighlight))
+  {
+    hint.kind = TRANSITION_MOVE;
+    hint.highlight = true;
+  }
+  mergeTransition(hint);
+}
+
+// Events drawn in the same frame become one transition, from the frame on screen to the last state.
+void Container::mergeTransition(const TransitionHint &next)
+{
+  TransitionHint &pending = m_transitionHint;
+  if (pending.kind == TRANSITION_NONE)
+  {
+    pending = next;
+    return;
+  }
+  if (pending.kind == TRANSITION_CUT || next.kind == TRANSITION_CUT)
+  {
+    pending.kind = TRANSITION_CUT;
+    return;
+  }
+
+  TransitionRect from = pending.fromHighlight;
+  if (pending.kind == TRANSITION_SLIDE && next.kind == TRANSITION_SLIDE)
+  {
+    pending = next;
+  }
+  else if (pending.kind != TRANSITION_SLIDE && next.kind != TRANSITION_SLIDE)
+  {
+    int32_t distance = pending.distance + next.distance;
+    pending = next;
+    pending.distance = distance;
+    pending.kind = distance == 0 ? TRANSITION_MOVE : TRANSITION_SCROLL;
+    if (distance != 0 && (distance >= pending.region.h || -distance >= pending.region.h)) // context moves have no region
+    {
+      pending.kind = TRANSITION_CUT;
+    }
+  }
+  else
+  {
+    pending.kind = TRANSITION_CUT;
+  }
+  pending.fromHighlight = from;
+}
+
+void Container::showPage(size_t idx)
+{
+  m_idx = idx;
+  m_currentPage = m_pages[m_idx];
+  SIMPLEUI_TRACE(TRACE_CONTAINER_PAGE, m_idx);
+  m_currentPage->activate(); // pages are started on first view, not at boot
+}
+
+void Container::prefetchNeighbours()
+{
+  // Runs after the frame is on screen, so it only costs idle time.
+  lockState();
+  size_t nextIdx = m_enabledPages.next(m_idx);
+  if (nextIdx != EnabledIndex::npos)
+  {
+    m_pages[nextIdx]->activate();
+  }
+  size_t prevIdx = m_enabledPages.prev(m_idx);
+  if (prevIdx != EnabledIndex::npos)
+  {
+    m_pages[prevIdx]->activate();
+  }
+  unlockState();
+}
+
+void Container::createRenderTask()
+{
+#ifndef SIMPLEUI_SYNC_RENDER
+  if (m_renderTaskHandle == nullptr)
+  {
+    xTaskCreate(
+        onContainerRenderTask,
+        "Render Task",
+        RENDER_TASK_STACK_SIZE,
+        this,
+        1 | portPRIVILEGE_BIT, // below the input callback tasks, so bursts of events collapse into one frame
+        &m_renderTaskHandle);
+  }
+#endif
 }
 
 void Container::drawOverlay()
@@ -161,95 +822,92 @@ void Container::drawOverlay()
 
 void Container::onEvent(Event &event)
 {
-  unsigned long id = millis() % 1000;
-  DEBUG_SIMPLEUI("-- %lu Container::onEvent %d %lu----\n", id, event.eventId, event.value);
-  DEBUG_SIMPLEUI("Container::onEvent:m_context %d\n", m_context);
-  DEBUG_SIMPLEUI("Container::onEvent:m_idx %d\n", m_idx);
+  SIMPLEUI_TRACE(TRACE_CONTAINER_EVENT, event.eventId, event.value, m_context);
 
   // Reset activity time and brightness on any user interaction
   m_lastActivityMs = millis();
+  restartScreenSaver();
 
+  lockState();
+  TransitionState before;
+  if (m_transitionMs > 0)
+  {
+    transitionState(before);
+  }
   if (m_screenBrightness < MAX_DISPLAY_BRIGHTNESS) // Don't unnecessarily change brightness as it make the display flicker
   {
     m_screenBrightness = MAX_DISPLAY_BRIGHTNESS;
-    m_display->setBrightness(MAX_DISPLAY_BRIGHTNESS);
-    draw();
-    DEBUG_SIMPLEUI("Container::onEvent: Woke from screen saver, ignoring event\n");
+    unlockState();
+    SIMPLEUI_TRACE(TRACE_CONTAINER_WAKE);
+    requestDraw(RENDER_FRAME | RENDER_BRIGHTNESS | eventCause(event));
     return; // Don't process 1st interaction after waking from screen saver
   }
 
   if (event.eventId == EVENT_ROT)
   {
-    if (m_context == NAVBAR)
-    {
-      DEBUG_SIMPLEUI("Container::onEvent NAVBAR:%d\n", event.value);
-      trackCurrentPage((ROTARY_EVENT)event.value);
-      m_navbar.onEvent(event);
-    }
-    else if (m_context == PAGE)
+    if (m_context == PAGE && m_currentPage)
     {
-      DEBUG_SIMPLEUI("Container::onEvent PAGE:%d\n", event.value);
-      m_currentPage->onEvent(event);
+      m_currentPage->activate(); // not started yet after restoreSnapshot()
     }
+    navigate((ROTARY_EVENT)event.value);
+  }
+  if (m_transitionMs > 0)
+  {
+    noteTransition(before);
   }
+  unlockState();
 
-  draw();
-  DEBUG_SIMPLEUI("-- %lu ------------\n", id);
+  requestDraw(RENDER_FRAME | eventCause(event));
 }
 
-void Container::onEventYield(Event &event)
+u_int32_t Container::eventCause(const Event &event)
 {
-  DEBUG_SIMPLEUI("Container::onEventYield\n");
-  if (event.eventId == EVENT_YIELD)
+  if (event.eventId != EVENT_ROT)
   {
-    CONTEXT who = (CONTEXT)event.value;
-    Event pushEvent = {EVENT_ROT, ROTARY_EVENT_PUSH};
-    if (who == NAVBAR)
-    {
-      m_context = PAGE;
-      DEBUG_SIMPLEUI("Container::onEventYield: EVENT_YIELD: NAVBAR -> PAGE\n");
-      m_currentPage->onEvent(pushEvent);
-    }
-    else if (who == PAGE)
-    {
-      m_context = NAVBAR;
-      DEBUG_SIMPLEUI("Container::onEventYield: EVENT_YIELD: PAGE -> NAVBAR\n");
-      m_navbar.onEvent(pushEvent);
-    }
+    return 0; // application event
   }
+  return event.value == ROTARY_EVENT_PUSH ? RENDER_CAUSE_PUSH : RENDER_CAUSE_ROTARY;
 }
 
 void Container::trackCurrentPage(ROTARY_EVENT rEvent)
 {
-  DEBUG_SIMPLEUI("Container::trackCurrentPage: %d\n", rEvent);
   if (rEvent == ROTARY_EVENT_CW && m_idx < m_pages.size() - 1)
   {
-    u_int8_t nextIdx = nextEnabledPage();
+    size_t nextIdx = nextEnabledPage();
     if (nextIdx != m_idx)
     {
-      m_idx = nextIdx;
-      m_currentPage = m_pages[m_idx];
+      showPage(nextIdx);
     }
   }
   else if (rEvent == ROTARY_EVENT_CCW && m_idx > 0)
   {
-    u_int8_t prevIdx = previousEnabledPage();
+    size_t prevIdx = previousEnabledPage();
     if (prevIdx != m_idx)
     {
-      m_idx = prevIdx;
-      m_currentPage = m_pages[m_idx];
+      showPage(prevIdx);
     }
   }
 }
 
 void Container::start()
 {
-  for (Page *page : m_pages)
+  m_lastActivityMs = millis();
+  restartScreenSaver();
+  if (m_frameRestored)
   {
-    page->start();
+    m_frameRestored = false; // already on screen, the page starts with the first event
   }
-  m_lastActivityMs = millis();
-  draw();
+  else
+  {
+    if (m_currentPage)
+    {
+      lockState();
+      showPage(m_idx);
+      unlockState();
+    }
+    draw();
+  }
+  createRenderTask();
   if (m_rotaryDebounce)
   {
     m_rotaryDebounce->start();
@@ -260,110 +918,118 @@ void Container::start()
   }
 }
 
-void Container::createWatchdogTask()
+void Container::enableScreenSaver(u_int8_t timeoutSec)
 {
-  if (m_watchdogTaskHandle == nullptr)
+  m_screenSaverTimeoutSec = timeoutSec < MIN_SCREEN_SAVER_TIMEOUT_SEC ? MIN_SCREEN_SAVER_TIMEOUT_SEC : timeoutSec;
+  m_lastActivityMs = millis();
+  if (m_screenSaverTimer == nullptr)
   {
-    xTaskCreate(
-        onWatchdogTask,
-        "watchdog Task",
-        1024,
-        &s_watchdogTaskParams,
-        1 | portPRIVILEGE_BIT,
-        &m_watchdogTaskHandle);
-
-    s_watchdogTaskParams.container = this;
+    m_screenSaverTimer = xTimerCreate("Screen Saver", pdMS_TO_TICKS(m_screenSaverTimeoutSec * 1000), pdFALSE, this, onContainerScreenSaverTimer);
+    xTimerStart(m_screenSaverTimer, portMAX_DELAY);
+  }
+  else
+  {
+    xTimerChangePeriod(m_screenSaverTimer, pdMS_TO_TICKS(m_screenSaverTimeoutSec * 1000), portMAX_DELAY); // also restarts it
   }
 }
 
-void Container::enableScreenSaver(u_int8_t timeoutSec)
+void Container::disableScreenSaver()
 {
-  createWatchdogTask();
+  m_screenSaverTimeoutSec = 0;
+  if (m_screenSaverTimer)
+  {
+    xTimerStop(m_screenSaverTimer, portMAX_DELAY);
+  }
+}
 
-  m_screenSaverTimeoutSec = timeoutSec < MIN_SCREEN_SAVER_TIMEOUT_SEC ? MIN_SCREEN_SAVER_TIMEOUT_SEC : timeoutSec;
-  m_lastActivityMs = millis();
+void Container::restartScreenSaver()
+{
+  if (m_screenSaverTimer && m_screenSaverTimeoutSec > 0)
+  {
+    // Not xTimerReset(): the callback may have shortened the period to the rest of a timeout.
+    xTimerChangePeriod(m_screenSaverTimer, pdMS_TO_TICKS(m_screenSaverTimeoutSec * 1000), 0);
+  }
 }
 
-void Container::disableScreenSaver()
+size_t Container::nextEnabledPage()
 {
-  m_screenSaverTimeoutSec = 0;
+  size_t nextIdx = m_enabledPages.next(m_idx);
+  return nextIdx == EnabledIndex::npos ? m_idx : nextIdx;
 }
 
-void Container::onWatchdogTask(void *parameter)
+size_t Container::previousEnabledPage()
 {
-  WatchdogTaskParams *params = (WatchdogTaskParams *)parameter;
-  Container *container = params->container;
+  size_t prevIdx = m_enabledPages.prev(m_idx);
+  return prevIdx == EnabledIndex::npos ? m_idx : prevIdx;
+}
 
-  for (;;)
-  {
-    // Check every second
-    vTaskDelay(pdMS_TO_TICKS(1000));
+void Container::onPageEnabledChanged(u_int16_t position, bool enabled)
+{
+  m_enabledPages.set(position, enabled);
+}
 
-    if (container->m_screenSaverTimeoutSec > 0)
-    {
-      container->screenSaverTask(params);
-    }
-  }
+void Container::flipDisplay(bool flipVertical)
+{
+  m_flipVertical = flipVertical;
+  requestDraw(RENDER_FRAME | RENDER_ORIENTATION);
 }
 
-void Container::screenSaverTask(WatchdogTaskParams *params)
+void Container::getResourceStats(ResourceStats &stats) const
 {
-  u_int32_t timeoutMs = m_screenSaverTimeoutSec * 1000;
-  if (timeoutMs < MIN_SCREEN_SAVER_TIMEOUT_SEC * 1000)
+  memset(&stats, 0, sizeof(stats));
+
+  TaskStats &renderTask = stats.tasks[RESOURCE_TASK_RENDER];
+  renderTask.name = "Render";
+  renderTask.stackSize = RENDER_TASK_STACK_SIZE;
+  renderTask.created = m_renderTaskHandle != nullptr;
+  if (renderTask.created)
   {
-    return; // Last check before proceeding for thread safety.
+    renderTask.stackHighWaterMark = uxTaskGetStackHighWaterMark(m_renderTaskHandle);
+    stats.heapBytes += RENDER_TASK_STACK_SIZE + sizeof(StaticTask_t);
   }
 
-  unsigned long lastActivity = m_lastActivityMs;
-  u_int32_t currentTime = millis();
-  u_int32_t elapsedMs = currentTime - lastActivity;
-  if (elapsedMs >= timeoutMs)
+  TimerStats &overlayTimer = stats.timers[RESOURCE_TIMER_PERF_OVERLAY];
+  overlayTimer.name = "Overlay Tmr";
+  overlayTimer.periodMs = PERF_OVERLAY_REFRESH_MS;
+  overlayTimer.active = m_perfOverlay.refreshTimer != nullptr && xTimerIsTimerActive(m_perfOverlay.refreshTimer) != pdFALSE;
+  if (m_perfOverlay.refreshTimer)
   {
-    if (m_screenBrightness > MIN_DISPLAY_BRIGHTNESS)
-    {
-      m_screenBrightness = MIN_DISPLAY_BRIGHTNESS;
-
-      m_display->setBrightness(MIN_DISPLAY_BRIGHTNESS);
-      m_display->clear();
-      drawOverlay();
-      m_display->display();
-    }
+    stats.heapBytes += sizeof(StaticTimer_t);
   }
-}
 
-u_int8_t Container::nextEnabledPage()
-{
-  for (u_int8_t i = m_idx + 1; i < m_pages.size(); i++)
+  TimerStats &screenSaverTimer = stats.timers[RESOURCE_TIMER_SCREEN_SAVER];
+  screenSaverTimer.name = "Saver Tmr";
+  screenSaverTimer.periodMs = m_screenSaverTimeoutSec * 1000;
+  screenSaverTimer.active = m_screenSaverTimer != nullptr && xTimerIsTimerActive(m_screenSaverTimer) != pdFALSE;
+  if (m_screenSaverTimer)
   {
-    if (m_pages[i]->enabled())
-    {
-      return i;
-    }
+    stats.heapBytes += sizeof(StaticTimer_t);
   }
-  return m_idx;
-}
 
-u_int8_t Container::previousEnabledPage()
-{
-  for (int i = m_idx - 1; i >= 0; i--)
+  // Every row is named, with or without an encoder or switch on this container.
+  RotaryDebounce::getResourceStats(stats);
+  if (m_rotaryDebounce)
   {
-    if (m_pages[i]->enabled())
-    {
-      return i;
-    }
+    stats.heapBytes += sizeof(RotaryDebounce);
   }
-  return m_idx;
-}
-
-void Container::flipDisplay(bool flipVertical)
-{
-  if (flipVertical)
+  if (m_switchDebounce)
   {
-    m_display->flipScreenVertically();
+    m_switchDebounce->getResourceStats(stats);
   }
   else
   {
-    m_display->resetOrientation();
+    SwitchDebounce::getSharedResourceStats(stats);
+    stats.timers[RESOURCE_TIMER_SWITCH_DEBOUNCE].name = "Switch Tmr";
   }
-  draw();
-}
\ No newline at end of file
+
+  stats.heapBytes += m_transition.heapUsage();
+  stats.heapBytes += sizeof(Container);
+  stats.heapBytes += m_pages.capacity() * sizeof(Page *);
+  stats.heapBytes += m_enabledPages.heapUsage();
+  for (const Page *page : m_pages)
+  {
+    stats.heapBytes += page->heapUsage();
+  }
+
+  stats.freeHeap = ESP.getFreeHeap();
+}
@@ -0,0 +1,111 @@
+#include "simpleUI.h"
+#include "itemRenderer.h"
+
+#define DIAGNOSTICS_ROW_COUNT (RESOURCE_TASK_COUNT + RESOURCE_QUEUE_COUNT + RESOURCE_TIMER_COUNT + 3)
+#define DIAGNOSTICS_VALUE_SIZE 32 // worst case "65535/65535/65535!4294967295"
+
+// Read-only page listing Container::getResourceStats(), one resource per row:
+//   tasks:  "<name>"       "<high water mark>/<stack size>"
+//   queues: "<name>"       "<depth>/<peak>/<length>" (+ "!<dropped>" when events were dropped)
+//   timers: "<name>"       "on"/"off" <period>ms
+//   heap:   "Heap (lib)"   bytes owned by the library for this container
+//           "Heap (shared)" rotary and switch tasks and queues, shared by every container
+//           "Heap (free)"  system free heap
+// Rotate to scroll, push to return to the navbar.
+
+void DiagnosticsPage::drawItems()
+{
+  ResourceStats stats;
+  m_container->getResourceStats(stats);
+
+  char value[DIAGNOSTICS_VALUE_SIZE];
+  for (u_int8_t drawIdx = 0; drawIdx < LIST_PAGE_DRAW_SIZE; drawIdx++)
+  {
+    u_int8_t row = m_firstRow + drawIdx;
+    const char *label = nullptr;
+
+    if (row < RESOURCE_TASK_COUNT)
+    {
+      const TaskStats &task = stats.tasks[row];
+      label = task.name ? task.name : "-";
+      if (task.created)
+      {
+        snprintf(value, sizeof(value), "%lu/%lu", (unsigned long)task.stackHighWaterMark, (unsigned long)task.stackSize);
+      }
+      else
+      {
+        snprintf(value, sizeof(value), "-");
+      }
+    }
+    else if ((row -= RESOURCE_TASK_COUNT) < RESOURCE_QUEUE_COUNT)
+    {
+      const QueueStats &queue = stats.queues[row];
+      label = queue.name ? queue.name : "-";
+      if (queue.dropped > 0)
+      {
+        snprintf(value, sizeof(value), "%u/%u/%u!%lu", queue.depth, queue.peak, queue.length, (unsigned long)queue.dropped);
+      }
+      else
+      {
+        snprintf(value, sizeof(value), "%u/%u/%u", queue.depth, queue.peak, queue.length);
+      }
+    }
+    else if ((row -= RESOURCE_QUEUE_COUNT) < RESOURCE_TIMER_COUNT)
+    {
+      const TimerStats &timer = stats.timers[row];
+      label = timer.name ? timer.name : "-";
+      snprintf(value, sizeof(value), "%s %lums", timer.active ? "on" : "off", (unsigned long)timer.periodMs);
+    }
+    else if ((row -= RESOURCE_TIMER_COUNT) == 0)
+    {
+      label = "Heap (lib)";
+      snprintf(value, sizeof(value), "%lu", (unsigned long)stats.heapBytes);
+    }
+    else if (row == 1)
+    {
+      label = "Heap (shared)";
+      snprintf(value, sizeof(value), "%lu", (unsigned long)stats.sharedHeapBytes);
+    }
+    else if (row == 2)
+    {
+      label = "Heap (free)";
+      snprintf(value, sizeof(value), "%lu", (unsigned long)stats.freeHeap);
+    }
+
+    if (label == nullptr)
+    {
+      break; // past the last row
+    }
+    PageItemRenderer::draw(m_display, drawIdx, label, value);
+  }
+}
+
+bool DiagnosticsPage::moveSelection(int8_t step)
+{
+  if (step > 0 && m_firstRow + LIST_PAGE_DRAW_SIZE < DIAGNOSTICS_ROW_COUNT)
+  {
+    m_firstRow++;
+    return true;
+  }
+  if (step < 0 && m_firstRow > 0)
+  {
+    m_firstRow--;
+    return true;
+  }
+  return false;
+}
+
+void DiagnosticsPage::reset()
+{
+  m_firstRow = 0;
+}
+
+bool DiagnosticsPage::restoreCursor(u_int32_t cursor)
+{
+  if (cursor != 0 && cursor + LIST_PAGE_DRAW_SIZE > DIAGNOSTICS_ROW_COUNT)
+  {
+    return false;
+  }
+  m_firstRow = cursor;
+  return true;
+}
@@ -0,0 +1,56 @@
+#ifndef Futojin_DISPLAY_H
+#define Futojin_DISPLAY_H
+
+// Display transport, chosen at compile time so the draw path has no extra indirection:
+//
+//   (default)                     SH1106 over I2C   SH1106Wire
+//   SIMPLEUI_DISPLAY_SH1106_SPI   SH1106 over SPI   SH1106Spi
+//   SIMPLEUI_DISPLAY_SSD1306_SPI  SSD1306 over SPI  SSD1306Spi
+//   SIMPLEUI_DISPLAY_FRAMEBUFFER  in-memory frame buffer, for simulators and host builds
+//
+// The library only relies on this subset of the OLEDDisplay API, which any other backend must provide:
+//   drawing    clear(), setColor(), setPixel(), drawRect(), fillRect(), drawVerticalLine(), drawXbm(),
+//              setFont(), setTextAlignment(), drawString(), getStringWidth(), getWidth(), getHeight()
+//   flush      init(), display() - sends only the region that changed since the previous display()
+//   contrast   setBrightness(), setContrast()
+//   power      displayOn(), displayOff()
+//   geometry   flipScreenVertically(), resetOrientation()
+//
+// The SIMPLEUI_BUS_* values describe what the driver's display() puts on the bus, so Container::getBusStats()
+// can estimate traffic without touching the driver: commands per flush and per changed page row, bytes per
+// command, and how the data of a page row is split into transactions (0: one transaction per row).
+
+#if defined(SIMPLEUI_DISPLAY_SH1106_SPI)
+#include "SH1106Spi.h"
+typedef SH1106Spi SimpleUIDisplay;
+#define SIMPLEUI_BUS_FLUSH_COMMANDS 0
+#define SIMPLEUI_BUS_PAGE_COMMANDS 3
+#define SIMPLEUI_BUS_COMMAND_BYTES 1
+#define SIMPLEUI_BUS_CHUNK_BYTES 0
+#define SIMPLEUI_BUS_CHUNK_OVERHEAD 0
+#elif defined(SIMPLEUI_DISPLAY_SSD1306_SPI)
+#include "SSD1306Spi.h"
+typedef SSD1306Spi SimpleUIDisplay;
+#define SIMPLEUI_BUS_FLUSH_COMMANDS 6
+#define SIMPLEUI_BUS_PAGE_COMMANDS 0
+#define SIMPLEUI_BUS_COMMAND_BYTES 1
+#define SIMPLEUI_BUS_CHUNK_BYTES 0
+#define SIMPLEUI_BUS_CHUNK_OVERHEAD 0
+#elif defined(SIMPLEUI_DISPLAY_FRAMEBUFFER)
+#include "framebufferDisplay.h"
+typedef FramebufferDisplay SimpleUIDisplay;
+#else
+#include "SH1106Wire.h"
+typedef SH1106Wire SimpleUIDisplay;
+#endif
+
+// SH1106 over I2C; the framebuffer backend reports the traffic of the default panel.
+#ifndef SIMPLEUI_BUS_FLUSH_COMMANDS
+#define SIMPLEUI_BUS_FLUSH_COMMANDS 0
+#define SIMPLEUI_BUS_PAGE_COMMANDS 3
+#define SIMPLEUI_BUS_COMMAND_BYTES 3  // address, control byte, command
+#define SIMPLEUI_BUS_CHUNK_BYTES 16   // data bytes per I2C write
+#define SIMPLEUI_BUS_CHUNK_OVERHEAD 2 // address, control byte
+#endif
+
+#endif // Futojin_DISPLAY_H
@@ -0,0 +1,117 @@
+#include "simpleUI.h"
+
+// Fenwick (binary indexed) tree over the enabled flags. m_tree is 1-based: m_tree[i] holds the number of
+// enabled positions in (i - lowbit(i), i].
+
+static inline size_t lowbit(size_t i)
+{
+  return i & (~i + 1);
+}
+
+void EnabledIndex::push_back(bool enabled)
+{
+  m_enabled.push_back(enabled);
+  if (m_tree.empty())
+  {
+    m_tree.push_back(0); // unused slot 0
+  }
+
+  // New node i covers (i - lowbit(i), i]: its own flag plus the already complete child nodes.
+  size_t i = m_enabled.size();
+  u_int16_t sum = enabled ? 1 : 0;
+  for (size_t child = i - 1; child > i - lowbit(i); child -= lowbit(child))
+  {
+    sum += m_tree[child];
+  }
+  m_tree.push_back(sum);
+
+  if (enabled)
+  {
+    m_count++;
+  }
+}
+
+void EnabledIndex::set(size_t pos, bool enabled)
+{
+  if (pos >= m_enabled.size() || m_enabled[pos] == enabled)
+  {
+    return;
+  }
+  m_enabled[pos] = enabled;
+  if (enabled)
+  {
+    m_count++;
+    for (size_t i = pos + 1; i < m_tree.size(); i += lowbit(i))
+    {
+      m_tree[i]++;
+    }
+  }
+  else
+  {
+    m_count--;
+    for (size_t i = pos + 1; i < m_tree.size(); i += lowbit(i))
+    {
+      m_tree[i]--;
+    }
+  }
+}
+
+void EnabledIndex::clear()
+{
+  m_enabled.clear();
+  m_tree.clear();
+  m_count = 0;
+}
+
+size_t EnabledIndex::rank(size_t pos) const
+{
+  size_t sum = 0;
+  for (size_t i = pos < m_enabled.size() ? pos : m_enabled.size(); i > 0; i -= lowbit(i))
+  {
+    sum += m_tree[i];
+  }
+  return sum;
+}
+
+size_t EnabledIndex::select(size_t k) const
+{
+  if (k >= m_count)
+  {
+    return npos;
+  }
+
+  // Descend the implicit tree: find the largest prefix holding exactly k enabled positions.
+  size_t n = m_enabled.size();
+  size_t step = 1;
+  while (step * 2 <= n)
+  {
+    step *= 2;
+  }
+
+  size_t pos = 0;
+  for (; step > 0; step /= 2)
+  {
+    if (pos + step <= n && m_tree[pos + step] <= k)
+    {
+      pos += step;
+      k -= m_tree[pos];
+    }
+  }
+  return pos; // 0-based position of the (k+1)th enabled entry
+}
+
+size_t EnabledIndex::next(size_t pos) const
+{
+  return select(rank(pos + 1));
+}
+
+size_t EnabledIndex::prev(size_t pos) const
+{
+  size_t r = rank(pos);
+  return r > 0 ? select(r - 1) : npos;
+}
+
+size_t EnabledIndex::heapUsage() const
+{
+  return m_tree.capacity() * sizeof(u_int16_t) + (m_enabled.capacity() + 7) / 8;
+}
@@ -0,0 +1,138 @@
+#include "simpleUI.h"
+
+EventBus::EventBus()
+    : m_count(0),
+      m_lock(xSemaphoreCreateMutex())
+{
+}
+
+EventBus::~EventBus()
+{
+  vSemaphoreDelete(m_lock);
+}
+
+bool EventBus::add(u_int8_t kind, void *target, void (*handler)(const Event &event, void *arg), const EventFilter &filter)
+{
+  xSemaphoreTake(m_lock, portMAX_DELAY);
+  if (m_count == SIMPLEUI_EVENT_BUS_SUBSCRIBERS)
+  {
+    xSemaphoreGive(m_lock);
+    return false;
+  }
+  Subscriber &subscriber = m_subscribers[m_count++];
+  subscriber.events = filter.events;
+  subscriber.valueMask = filter.valueMask;
+  subscriber.valueMatch = filter.valueMatch;
+  subscriber.kind = kind;
+  subscriber.target = target;
+  subscriber.handler = handler;
+  xSemaphoreGive(m_lock);
+  return true;
+}
+
+bool EventBus::subscribe(Item &item, EventFilter filter)
+{
+  return add(SUBSCRIBER_ITEM, &item, nullptr, filter);
+}
+
+bool EventBus::subscribe(Page &page, EventFilter filter)
+{
+  return add(SUBSCRIBER_PAGE, &page, nullptr, filter);
+}
+
+bool EventBus::subscribe(void (*handler)(const Event &event, void *arg), void *arg, EventFilter filter)
+{
+  return handler != nullptr && add(SUBSCRIBER_HANDLER, arg, handler, filter);
+}
+
+void EventBus::unsubscribe(const void *subscriber)
+{
+  xSemaphoreTake(m_lock, portMAX_DELAY);
+  size_t kept = 0;
+  for (size_t i = 0; i < m_count; i++)
+  {
+    if (m_subscribers[i].target != subscriber)
+    {
+      m_subscribers[kept++] = m_subscribers[i]; // keeps the delivery order
+    }
+  }
+  m_count = kept;
+  xSemaphoreGive(m_lock);
+}
+
+size_t EventBus::publish(Event_ID eventId, unsigned long value)
+{
+  if (eventId >= EVENT_BUS_IDS)
+  {
+    return 0;
+  }
+  // Subscribers run on a copy of the table, so they can subscribe, unsubscribe or publish themselves.
+  Subscriber subscribers[SIMPLEUI_EVENT_BUS_SUBSCRIBERS];
+  size_t count = 0;
+  xSemaphoreTake(m_lock, portMAX_DELAY);
+  for (size_t i = 0; i < m_count; i++)
+  {
+    const Subscriber &subscriber = m_subscribers[i];
+    if ((subscriber.events & EVENT_MASK(eventId)) && (value & subscriber.valueMask) == subscriber.valueMatch)
+    {
+      subscribers[count++] = subscriber;
+    }
+  }
+  xSemaphoreGive(m_lock);
+
+  // Items on screen share one frame per container, however many of them changed.
+  Container *redraw[SIMPLEUI_EVENT_BUS_SUBSCRIBERS];
+  size_t redraws = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    Event event = {eventId, value};
+    deliver(subscribers[i], event, redraw, redraws);
+  }
+  for (size_t i = 0; i < redraws; i++)
+  {
+    redraw[i]->requestDraw(Container::RENDER_FRAME);
+  }
+  return count;
+}
+
+void EventBus::deliver(const Subscriber &subscriber, Event &event, Container **redraw, size_t &redraws)
+{
+  if (subscriber.kind == SUBSCRIBER_HANDLER)
+  {
+    subscriber.handler(event, subscriber.target);
+    return;
+  }
+
+  Page *page = subscriber.kind == SUBSCRIBER_PAGE ? (Page *)subscriber.target : ((Item *)subscriber.target)->m_owner;
+  Container *container = page ? page->m_container : nullptr;
+  if (container)
+  {
+    container->lockState();
+  }
+  if (subscriber.kind == SUBSCRIBER_PAGE)
+  {
+    page->onBusEvent(event);
+  }
+  else
+  {
+    ((Item *)subscriber.target)->onEvent(event);
+  }
+  bool onScreen = container && container->m_currentPage == page;
+  if (container)
+  {
+    container->unlockState();
+  }
+
+  if (subscriber.kind == SUBSCRIBER_ITEM && onScreen)
+  {
+    size_t i = 0;
+    while (i < redraws && redraw[i] != container)
+    {
+      i++;
+    }
+    if (i == redraws)
+    {
+      redraw[redraws++] = container;
+    }
+  }
+}
@@ -0,0 +1,28 @@
+#include "display.h"
+#include "fonts.h"
+
+#ifdef SIMPLEUI_FONT_SUBSET
+#include SIMPLEUI_FONT_SUBSET // generated by tools/font_subset.py, defines SIMPLEUI_FONT_<ROLE>
+#endif
+
+#ifndef SIMPLEUI_FONT_ITEM_LABEL
+#define SIMPLEUI_FONT_ITEM_LABEL ArialMT_Plain_10
+#endif
+#ifndef SIMPLEUI_FONT_ITEM_VALUE
+#define SIMPLEUI_FONT_ITEM_VALUE ArialMT_Plain_10
+#endif
+#ifndef SIMPLEUI_FONT_HERO_LABEL
+#define SIMPLEUI_FONT_HERO_LABEL ArialMT_Plain_16
+#endif
+#ifndef SIMPLEUI_FONT_HERO_VALUE
+#define SIMPLEUI_FONT_HERO_VALUE ArialMT_Plain_24
+#endif
+#ifndef SIMPLEUI_FONT_PERF_OVERLAY
+#define SIMPLEUI_FONT_PERF_OVERLAY ArialMT_Plain_10
+#endif
+
+const uint8_t *const font_item_label = SIMPLEUI_FONT_ITEM_LABEL;
+const uint8_t *const font_item_value = SIMPLEUI_FONT_ITEM_VALUE;
+const uint8_t *const font_hero_label = SIMPLEUI_FONT_HERO_LABEL;
+const uint8_t *const font_hero_value = SIMPLEUI_FONT_HERO_VALUE;
+const uint8_t *const font_perf_overlay = SIMPLEUI_FONT_PERF_OVERLAY;
@@ -0,0 +1,20 @@
+#ifndef Futojin_FONTS_H
+#define Futojin_FONTS_H
+
+#include <stdint.h>
+
+// Font of each text role, in ThingPulse font format. The tables are only named in fonts.cpp:
+// OLEDDisplayFonts.h defines them as internal-linkage constants, so every translation unit naming a font
+// would link its own copy.
+//
+// Each role defaults to an ArialMT font from the display library. To ship only the glyphs a role needs,
+// generate subset tables with tools/font_subset.py and build with -DSIMPLEUI_FONT_SUBSET='"<header>"'.
+// Roles are overridden individually with SIMPLEUI_FONT_<ROLE>.
+
+extern const uint8_t *const font_item_label;   // PageItem labels, list rows, diagnostics
+extern const uint8_t *const font_item_value;   // PageItem values
+extern const uint8_t *const font_hero_label;   // HeroPageItem label
+extern const uint8_t *const font_hero_value;   // HeroPageItem value
+extern const uint8_t *const font_perf_overlay; // performance overlay
+
+#endif // Futojin_FONTS_H
@@ -0,0 +1,270 @@
+#include "simpleUI.h"
+
+#define SEND_TASK_STACK_SIZE 2048
+
+size_t FileMirrorSink::write(const uint8_t *data, size_t size)
+{
+  size_t written = fwrite(data, 1, size, m_file);
+  fflush(m_file);
+  return written;
+}
+
+static uint8_t *put16(uint8_t *out, u_int16_t value)
+{
+  out[0] = value;
+  out[1] = value >> 8;
+  return out + 2;
+}
+
+static uint8_t *put32(uint8_t *out, u_int32_t value)
+{
+  out = put16(out, value);
+  return put16(out, value >> 16);
+}
+
+// Worst case of encodePage(): all literals, one token per 128 bytes.
+static size_t encodedPageBound(u_int16_t width)
+{
+  return width + (width + 127) / 128;
+}
+
+// Encodes the XOR of a page with its reference (nullptr: all black) as the tokens described in frameMirror.h.
+static size_t encodePage(const uint8_t *page, const uint8_t *reference, u_int16_t width, uint8_t *out)
+{
+  uint8_t *start = out;
+  uint8_t *literal = nullptr; // token of the literal being extended
+  u_int16_t i = 0;
+  while (i < width)
+  {
+    uint8_t delta = page[i] ^ (reference ? reference[i] : 0);
+    u_int16_t run = 1;
+    while (i + run < width && run < 65 && (page[i + run] ^ (reference ? reference[i + run] : 0)) == delta)
+    {
+      run++;
+    }
+    // A lone zero is cheaper inside a literal than as a token of its own.
+    if (delta == 0 && (run >= 2 || literal == nullptr))
+    {
+      run = run > 64 ? 64 : run;
+      *out++ = 0x80 + run - 1;
+      literal = nullptr;
+    }
+    else if (run >= 3)
+    {
+      *out++ = 0xC0 + run - 2;
+      *out++ = delta;
+      literal = nullptr;
+    }
+    else
+    {
+      run = 1;
+      if (literal == nullptr || *literal == 0x7F)
+      {
+        literal = out++;
+        *literal = 0;
+      }
+      else
+      {
+        (*literal)++;
+      }
+      *out++ = delta;
+    }
+    i += run;
+  }
+  return out - start;
+}
+
+// A keyframe takes about 90 ms on a 115200 baud Serial, too long for the timer service task, which also runs
+// the debounce, screen saver and settings timers. The timer only wakes the send task.
+void frameMirror_timerCallback(TimerHandle_t timer)
+{
+  FrameMirror *mirror = (FrameMirror *)pvTimerGetTimerID(timer);
+  if (mirror->m_sendTaskHandle)
+  {
+    xTaskNotifyGive(mirror->m_sendTaskHandle);
+    return;
+  }
+  xSemaphoreTake(mirror->m_lock, portMAX_DELAY); // SIMPLEUI_SYNC_RENDER
+  mirror->sendPending();
+  xSemaphoreGive(mirror->m_lock);
+}
+
+void frameMirror_sendTask(void *parameter)
+{
+  FrameMirror *mirror = (FrameMirror *)parameter;
+  for (;;)
+  {
+    if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0)
+    {
+      xSemaphoreTake(mirror->m_lock, portMAX_DELAY);
+      mirror->sendPending();
+      xSemaphoreGive(mirror->m_lock);
+    }
+  }
+}
+
+FrameMirror::FrameMirror(MirrorSink &sink, u_int32_t maxBytesPerSecond)
+    : m_sink(sink),
+      m_maxBytesPerSecond(maxBytesPerSecond),
+      m_lock(xSemaphoreCreateMutex()),
+      m_sendTimer(nullptr),
+      m_sendTaskHandle(nullptr),
+      m_width(0),
+      m_pages(0),
+      m_reference(nullptr),
+      m_pending(nullptr),
+      m_message(nullptr),
+      m_hasPending(false),
+      m_keyframe(true),
+      m_sequence(0),
+      m_sinceKeyframe(0),
+      m_nextSendUs(0)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+FrameMirror::~FrameMirror()
+{
+  if (m_sendTimer)
+  {
+    xTimerDelete(m_sendTimer, portMAX_DELAY);
+  }
+  if (m_sendTaskHandle)
+  {
+    xSemaphoreTake(m_lock, portMAX_DELAY); // not in the middle of a message
+    vTaskDelete(m_sendTaskHandle);
+    xSemaphoreGive(m_lock);
+  }
+  vSemaphoreDelete(m_lock);
+  delete[] m_reference;
+  delete[] m_pending;
+  delete[] m_message;
+}
+
+bool FrameMirror::allocate(u_int16_t width, u_int8_t pages)
+{
+  if (width == m_width && pages == m_pages)
+  {
+    return true;
+  }
+  if (pages == 0 || pages > MIRROR_MAX_PAGES)
+  {
+    return false;
+  }
+  delete[] m_reference;
+  delete[] m_pending;
+  delete[] m_message;
+  size_t frameSize = (size_t)width * pages;
+  m_reference = new uint8_t[frameSize];
+  m_pending = new uint8_t[frameSize];
+  m_message = new uint8_t[MIRROR_HEADER_SIZE + pages * (2 + encodedPageBound(width)) + MIRROR_CRC_SIZE];
+  m_width = width;
+  m_pages = pages;
+  m_hasPending = false;
+  m_keyframe = true;
+  if (m_maxBytesPerSecond && m_sendTimer == nullptr)
+  {
+    m_sendTimer = xTimerCreate("Frame Mirror", 1, pdFALSE, this, frameMirror_timerCallback);
+#ifndef SIMPLEUI_SYNC_RENDER
+    xTaskCreate(
+        frameMirror_sendTask,
+        "Frame Mirror Task",
+        SEND_TASK_STACK_SIZE,
+        this,
+        1 | portPRIVILEGE_BIT, // same as the render task, which sends the frames the cap lets through at once
+        &m_sendTaskHandle);
+#endif
+  }
+  return true;
+}
+
+// The frame buffer is page-major like the display's: page p holds bytes [p * width, (p + 1) * width).
+void FrameMirror::onFrame(const uint8_t *buffer, u_int16_t width, u_int16_t height)
+{
+  xSemaphoreTake(m_lock, portMAX_DELAY);
+  if (!allocate(width, height / 8))
+  {
+    xSemaphoreGive(m_lock);
+    return;
+  }
+  m_stats.frames++;
+  m_stats.merged += m_hasPending ? 1 : 0;
+  memcpy(m_pending, buffer, (size_t)m_width * m_pages);
+  m_hasPending = true;
+
+  unsigned long nowUs = micros();
+  long waitUs = (long)(m_nextSendUs - nowUs);
+  if (m_maxBytesPerSecond == 0 || waitUs <= 0)
+  {
+    sendPending();
+  }
+  else if (!xTimerIsTimerActive(m_sendTimer))
+  {
+    // Changing the period starts the timer.
+    xTimerChangePeriod(m_sendTimer, pdMS_TO_TICKS((waitUs + 999) / 1000) + 1, 0);
+  }
+  xSemaphoreGive(m_lock);
+}
+
+void FrameMirror::sendPending()
+{
+  if (!m_hasPending)
+  {
+    return;
+  }
+  m_hasPending = false;
+  bool keyframe = m_keyframe || m_sinceKeyframe + 1 >= SIMPLEUI_MIRROR_KEYFRAME_INTERVAL;
+
+  uint8_t *out = m_message + MIRROR_HEADER_SIZE;
+  u_int16_t mask = 0;
+  for (u_int8_t page = 0; page < m_pages; page++)
+  {
+    const uint8_t *current = m_pending + page * m_width;
+    const uint8_t *reference = m_reference + page * m_width;
+    if (!keyframe && memcmp(current, reference, m_width) == 0)
+    {
+      continue;
+    }
+    size_t size = encodePage(current, keyframe ? nullptr : reference, m_width, out + 2);
+    put16(out, size);
+    out += 2 + size;
+    mask |= 1 << page;
+  }
+  if (mask == 0)
+  {
+    return; // the receiver already shows this frame
+  }
+
+  uint8_t *header = m_message;
+  header = put16(header, MIRROR_MAGIC);
+  header = put16(header, m_sequence++);
+  *header++ = keyframe ? MIRROR_FLAG_KEYFRAME : 0;
+  header = put16(header, m_width);
+  *header++ = m_pages;
+  put16(header, mask);
+  out = put32(out, snapshotCrc32(m_message, out - m_message));
+
+  size_t size = out - m_message;
+  size_t written = m_sink.write(m_message, size);
+  memcpy(m_reference, m_pending, (size_t)m_width * m_pages);
+  // The receiver missed part of the stream, it needs a fresh start.
+  m_keyframe = written != size;
+  m_sinceKeyframe = keyframe ? 0 : m_sinceKeyframe + 1;
+
+  m_stats.messages++;
+  m_stats.keyframes += keyframe ? 1 : 0;
+  m_stats.bytes += written;
+  m_stats.lastMessageBytes = size;
+  m_stats.maxMessageBytes = size > m_stats.maxMessageBytes ? size : m_stats.maxMessageBytes;
+  if (m_maxBytesPerSecond)
+  {
+    m_nextSendUs = micros() + (unsigned long)((u_int64_t)size * 1000000 / m_maxBytesPerSecond);
+  }
+}
+
+void FrameMirror::getStats(MirrorStats &stats) const
+{
+  xSemaphoreTake(m_lock, portMAX_DELAY);
+  stats = m_stats;
+  xSemaphoreGive(m_lock);
+}
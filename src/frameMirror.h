@@ -0,0 +1,112 @@
+#ifndef Futojin_FRAME_MIRROR_H
+#define Futojin_FRAME_MIRROR_H
+
+#include <Arduino.h>
+#include <stdio.h>
+
+// Stream of the frames a Container flushes, for watching a unit's display remotely. Each message carries
+// only the display pages (8-pixel rows) that changed, XORed with the frame the receiver already has and run
+// length encoded. tools/mirror_decode.py rebuilds the frames.
+//
+//   magic "FM"  sequence (2)  flags (1)  width (2)  pages (1)  page mask (2)
+//   per set mask bit, in page order: encoded size (2)  encoded XOR delta of the page
+//   CRC-32 of everything before it (4)
+//
+// Multi-byte fields are little endian. Encoded deltas are a sequence of tokens:
+//   0x00-0x7F  n + 1 literal bytes follow
+//   0x80-0xBF  n - 0x80 + 1 zero bytes (pixels unchanged)
+//   0xC0-0xFF  the next byte, repeated n - 0xC0 + 2 times
+// A keyframe (MIRROR_FLAG_KEYFRAME) is a delta against an all-black frame: receivers that joined late, or saw
+// a gap in the sequence numbers, wait for one.
+
+#define MIRROR_MAGIC 0x4D46 // "FM"
+#define MIRROR_HEADER_SIZE 10
+#define MIRROR_CRC_SIZE 4
+#define MIRROR_FLAG_KEYFRAME 0x01
+#define MIRROR_MAX_PAGES 16 // bits of the page mask
+
+#ifndef SIMPLEUI_MIRROR_KEYFRAME_INTERVAL
+#define SIMPLEUI_MIRROR_KEYFRAME_INTERVAL 64 // messages between keyframes
+#endif
+
+// Where FrameMirror writes its messages.
+class MirrorSink
+{
+public:
+  virtual ~MirrorSink() {}
+  // Returns the bytes accepted; a short write makes the next message a keyframe.
+  virtual size_t write(const uint8_t *data, size_t size) = 0;
+};
+
+// The Arduino Serial port, shared with anything else printed on it: the decoder resynchronizes on the
+// magic and checksum.
+class SerialMirrorSink : public MirrorSink
+{
+public:
+  size_t write(const uint8_t *data, size_t size) override { return Serial.write(data, size); }
+};
+
+// A stdio file or pipe, for host builds and captures.
+class FileMirrorSink : public MirrorSink
+{
+public:
+  FileMirrorSink(FILE *file) : m_file(file) {}
+  size_t write(const uint8_t *data, size_t size) override;
+
+private:
+  FILE *m_file;
+};
+
+struct MirrorStats
+{
+  u_int32_t messages;  // messages written
+  u_int32_t keyframes; // of which keyframes
+  u_int32_t frames;    // frames handed over by the container
+  u_int32_t merged;    // frames replaced by a newer one while waiting for the bandwidth cap
+  u_int32_t bytes;     // bytes written
+  u_int32_t lastMessageBytes;
+  u_int32_t maxMessageBytes;
+};
+
+/**
+ * Encodes the frames of a Container for a MirrorSink, see Container::setMirror(). maxBytesPerSecond caps the
+ * average stream rate (0: no cap). A frame that arrives before the stream may send again waits, and is
+ * replaced by any newer frame, so the receiver always converges to the frame on screen. Delayed frames are
+ * sent from the mirror's own task (2 KB of stack, created with a cap only). Buffers are allocated on the first
+ * frame; no allocation after that.
+ */
+class FrameMirror
+{
+  friend void frameMirror_timerCallback(TimerHandle_t timer);
+  friend void frameMirror_sendTask(void *parameter);
+
+public:
+  FrameMirror(MirrorSink &sink, u_int32_t maxBytesPerSecond = 0);
+  ~FrameMirror();
+  void onFrame(const uint8_t *buffer, u_int16_t width, u_int16_t height);
+  void requestKeyframe() { m_keyframe = true; }
+  void getStats(MirrorStats &stats) const;
+
+private:
+  MirrorSink &m_sink;
+  u_int32_t m_maxBytesPerSecond;
+  SemaphoreHandle_t m_lock; // the render task hands frames over, the send task sends delayed ones
+  TimerHandle_t m_sendTimer;
+  TaskHandle_t m_sendTaskHandle; // with a cap: wakes up when m_sendTimer expires
+  u_int16_t m_width;
+  u_int8_t m_pages;
+  uint8_t *m_reference; // frame the receiver has
+  uint8_t *m_pending;   // latest frame, not sent yet
+  uint8_t *m_message;
+  bool m_hasPending;
+  bool m_keyframe;
+  u_int16_t m_sequence;
+  u_int16_t m_sinceKeyframe;
+  unsigned long m_nextSendUs; // earliest time the cap allows the next message
+  MirrorStats m_stats;
+
+  bool allocate(u_int16_t width, u_int8_t pages);
+  void sendPending();
+};
+
+#endif // Futojin_FRAME_MIRROR_H
@@ -0,0 +1,107 @@
+#include "framebufferDisplay.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CMD_DISPLAY_OFF 0xAE
+#define CMD_DISPLAY_ON 0xAF
+#define CMD_SET_CONTRAST 0x81
+
+FramebufferDisplay::FramebufferDisplay(OLEDDISPLAY_GEOMETRY g)
+    : m_frame(nullptr),
+      m_on(false),
+      m_contrast(0),
+      m_lastCommand(0),
+      m_flushCount(0),
+      m_flushedBytes(0)
+{
+  setGeometry(g);
+}
+
+FramebufferDisplay::~FramebufferDisplay()
+{
+  free(m_frame);
+}
+
+bool FramebufferDisplay::connect()
+{
+  if (m_frame == nullptr)
+  {
+    m_frame = (uint8_t *)calloc(displayBufferSize, 1);
+  }
+  return m_frame != nullptr;
+}
+
+void FramebufferDisplay::display()
+{
+  if (buffer == nullptr || m_frame == nullptr)
+  {
+    return;
+  }
+  m_flushCount++;
+
+  // Same dirty-rectangle rule as the SH1106/SSD1306 drivers: one column range shared by every changed page.
+  uint16_t pages = displayHeight / 8;
+  uint16_t minX = UINT16_MAX;
+  uint16_t maxX = 0;
+  uint16_t minPage = UINT16_MAX;
+  uint16_t maxPage = 0;
+  for (uint16_t page = 0; page < pages; page++)
+  {
+    for (uint16_t x = 0; x < displayWidth; x++)
+    {
+      uint16_t pos = x + page * displayWidth;
+      if (buffer[pos] != m_frame[pos])
+      {
+        minX = x < minX ? x : minX;
+        maxX = x > maxX ? x : maxX;
+        minPage = page < minPage ? page : minPage;
+        maxPage = page > maxPage ? page : maxPage;
+      }
+    }
+  }
+
+  if (minPage == UINT16_MAX)
+  {
+    return; // nothing changed
+  }
+
+  uint16_t columns = maxX - minX + 1;
+  for (uint16_t page = minPage; page <= maxPage; page++)
+  {
+    memcpy(m_frame + page * displayWidth + minX, buffer + page * displayWidth + minX, columns);
+  }
+  m_flushedBytes += (uint32_t)columns * (maxPage - minPage + 1);
+
+#ifdef OLEDDISPLAY_DOUBLE_BUFFER
+  memcpy(buffer_back, buffer, displayBufferSize);
+#endif
+}
+
+bool FramebufferDisplay::getPixel(int16_t x, int16_t y) const
+{
+  if (m_frame == nullptr || x < 0 || x >= displayWidth || y < 0 || y >= displayHeight)
+  {
+    return false;
+  }
+  return m_frame[x + (y / 8) * displayWidth] & (1 << (y & 7));
+}
+
+void FramebufferDisplay::sendCommand(uint8_t command)
+{
+  if (m_lastCommand == CMD_SET_CONTRAST)
+  {
+    m_contrast = command;
+    m_lastCommand = 0; // argument byte, not a command
+    return;
+  }
+
+  if (command == CMD_DISPLAY_ON)
+  {
+    m_on = true;
+  }
+  else if (command == CMD_DISPLAY_OFF)
+  {
+    m_on = false;
+  }
+  m_lastCommand = command;
+}
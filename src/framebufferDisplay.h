@@ -0,0 +1,39 @@
+#ifndef Futojin_FRAMEBUFFER_DISPLAY_H
+#define Futojin_FRAMEBUFFER_DISPLAY_H
+
+#include "OLEDDisplay.h"
+
+/**
+ * Display backend without a panel: display() copies the changed region of the frame buffer into an
+ * in-memory "panel" frame. Used by simulators and host builds, and to inspect what a frame would send.
+ * Select it with SIMPLEUI_DISPLAY_FRAMEBUFFER.
+ */
+class FramebufferDisplay : public OLEDDisplay
+{
+public:
+  FramebufferDisplay(OLEDDISPLAY_GEOMETRY g = GEOMETRY_128_64);
+  ~FramebufferDisplay();
+  void display() override;
+
+  const uint8_t *frame() const { return m_frame; } // SH1106 page layout: x + (y / 8) * width
+  bool getPixel(int16_t x, int16_t y) const;
+  bool isOn() const { return m_on; }
+  uint8_t contrast() const { return m_contrast; }
+  uint32_t flushCount() const { return m_flushCount; }
+  uint32_t flushedBytes() const { return m_flushedBytes; } // frame bytes copied by all display() calls
+
+protected:
+  int getBufferOffset() override { return 0; }
+  void sendCommand(uint8_t command) override;
+  bool connect() override;
+
+private:
+  uint8_t *m_frame;
+  bool m_on;
+  uint8_t m_contrast;
+  uint8_t m_lastCommand;
+  uint32_t m_flushCount;
+  uint32_t m_flushedBytes;
+};
+
+#endif // Futojin_FRAMEBUFFER_DISPLAY_H
@@ -0,0 +1,293 @@
+#include "simpleUI.h"
+#include "itemRenderer.h"
+
+#define GRAPH_LABEL_WIDTH 30 // right of the plot, for the min/max labels
+
+// Moves the pixels inside rect left by columns and clears the columns that become free on the right.
+static void shiftLeft(SimpleUIDisplay *display, const TransitionRect &rect, int16_t columns)
+{
+  int16_t width = display->getWidth();
+  for (int16_t page = rect.y / 8; page <= (rect.y + rect.h - 1) / 8; page++)
+  {
+    int16_t top = rect.y > page * 8 ? rect.y - page * 8 : 0;
+    int16_t bottom = rect.y + rect.h < (page + 1) * 8 ? rect.y + rect.h - page * 8 : 8;
+    uint8_t mask = ((1 << bottom) - 1) & ~((1 << top) - 1);
+    uint8_t *row = display->buffer + page * width;
+    int16_t x = rect.x;
+    for (; x < rect.x + rect.w - columns; x++)
+    {
+      row[x] = (row[x] & ~mask) | (row[x + columns] & mask);
+    }
+    for (; x < rect.x + rect.w; x++)
+    {
+      row[x] &= ~mask;
+    }
+  }
+}
+
+GraphItem::GraphItem(const char *label, size_t capacity, GRAPH_MODE mode, void (*valueChangeResponder)(Item *item, const Event *event))
+    : HeroPageItem(label, valueChangeResponder),
+      m_samples(new float[capacity > 0 ? capacity : 1]),
+      m_capacity(capacity > 0 ? capacity : 1),
+      m_head(0),
+      m_pushMutex(xSemaphoreCreateMutex()),
+      m_mode(mode),
+      m_autoscale(true),
+      m_rangeMin(0),
+      m_rangeMax(0),
+      m_decimals(1),
+      m_drawn(false),
+      m_drawnHead(0),
+      m_drawnMin(0),
+      m_drawnMax(0),
+      m_lastY(0),
+      m_valueWidth(0)
+{
+  m_valueLabel[0] = '\0';
+  m_minLabel[0] = '\0';
+  m_maxLabel[0] = '\0';
+  value = m_valueLabel;
+}
+
+GraphItem::~GraphItem()
+{
+  vSemaphoreDelete(m_pushMutex);
+  delete[] m_samples;
+}
+
+void GraphItem::push(float sample)
+{
+  // One producer at a time: the slot is written before the new head is published to the render task.
+  xSemaphoreTake(m_pushMutex, portMAX_DELAY);
+  u_int32_t head = m_head;
+  m_samples[head % m_capacity] = sample;
+  __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+  xSemaphoreGive(m_pushMutex);
+  requestUpdate();
+}
+
+void GraphItem::setRange(float min, float max)
+{
+  m_autoscale = false;
+  m_rangeMin = min;
+  m_rangeMax = max;
+  requestUpdate();
+}
+
+size_t GraphItem::count() const
+{
+  u_int32_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+  return head < m_capacity ? head : m_capacity;
+}
+
+// Plot area, left of the labels and above the navbar. The highlight is drawn just outside of it.
+TransitionRect GraphItem::plotRect() const
+{
+  int16_t x = PAGE_ITEM_DRAW_X_MARGIN;
+  int16_t y = PAGE_ITEM_DRAW_HEIGHT + 1;
+  TransitionRect rect = {x, y, (int16_t)(m_display->getWidth() - 2 * x - GRAPH_LABEL_WIDTH),
+                         (int16_t)(m_display->getHeight() - ICON_SIZE - 3 - y)};
+  return rect;
+}
+
+// Scale of the last columns samples before head.
+void GraphItem::scale(u_int32_t head, u_int16_t columns, float &min, float &max) const
+{
+  if (!m_autoscale)
+  {
+    min = m_rangeMin;
+    max = m_rangeMax;
+  }
+  else
+  {
+    u_int32_t first = head > columns ? head - columns : 0;
+    first = head - first > m_capacity ? head - m_capacity : first;
+    min = head > first ? sample(first) : 0;
+    max = min;
+    for (u_int32_t i = first + 1; i < head; i++)
+    {
+      float value = sample(i);
+      min = value < min ? value : min;
+      max = value > max ? value : max;
+    }
+  }
+  if (max <= min)
+  {
+    max = min + 1; // flat line at the bottom
+  }
+}
+
+int16_t GraphItem::plotY(float value, float min, float max, const TransitionRect &plot) const
+{
+  float offset = (value - min) * (plot.h - 1) / (max - min) + 0.5f;
+  int16_t rows = offset < 0 ? 0 : (offset > plot.h - 1 ? plot.h - 1 : (int16_t)offset);
+  return plot.y + plot.h - 1 - rows;
+}
+
+void GraphItem::drawPlot(u_int32_t head, float min, float max)
+{
+  TransitionRect plot = plotRect();
+  u_int32_t columns = m_mode == GRAPH_SWEEP ? plot.w - 1 : plot.w; // the sweep keeps a gap at the cursor
+  u_int32_t visible = head < columns ? head : columns;
+  visible = visible < m_capacity ? visible : m_capacity;
+
+  m_display->setColor(BLACK);
+  m_display->fillRect(plot.x, plot.y, plot.w, plot.h);
+  m_display->setColor(WHITE);
+  int16_t previousY = -1;
+  for (u_int32_t i = head - visible; i < head; i++)
+  {
+    int16_t x = m_mode == GRAPH_SWEEP ? plot.x + i % plot.w : plot.x + plot.w - (head - i);
+    int16_t y = plotY(sample(i), min, max, plot);
+    if (previousY < 0 || (m_mode == GRAPH_SWEEP && x == plot.x))
+    {
+      previousY = y; // no line back from the right edge
+    }
+    int16_t top = y < previousY ? y : previousY;
+    m_display->drawVerticalLine(x, top, (y < previousY ? previousY - y : y - previousY) + 1);
+    previousY = y;
+  }
+  m_lastY = previousY;
+}
+
+void GraphItem::drawScaleLabels(float min, float max)
+{
+  char minLabel[GRAPH_LABEL_SIZE];
+  char maxLabel[GRAPH_LABEL_SIZE];
+  snprintf(minLabel, sizeof(minLabel), "%.*f", m_decimals, min);
+  snprintf(maxLabel, sizeof(maxLabel), "%.*f", m_decimals, max);
+  if (m_drawn && strcmp(minLabel, m_minLabel) == 0 && strcmp(maxLabel, m_maxLabel) == 0)
+  {
+    return;
+  }
+  strcpy(m_minLabel, minLabel);
+  strcpy(m_maxLabel, maxLabel);
+
+  TransitionRect plot = plotRect();
+  int16_t x = plot.x + plot.w + 1; // right of the highlight
+  int16_t right = m_display->getWidth() - PAGE_ITEM_DRAW_X_MARGIN;
+  m_display->setColor(BLACK);
+  m_display->fillRect(x, plot.y - 1, right - x + 1, plot.h + 1);
+  m_display->setColor(WHITE);
+  m_display->setFont(font_item_value);
+  m_display->setTextAlignment(TEXT_ALIGN_RIGHT);
+  m_display->drawString(right, plot.y - 1, m_maxLabel);
+  m_display->drawString(right, plot.y + plot.h - PAGE_ITEM_DRAW_HEIGHT, m_minLabel);
+}
+
+void GraphItem::drawValueLabel(u_int32_t head)
+{
+  char label[GRAPH_LABEL_SIZE];
+  label[0] = '\0';
+  if (head > 0)
+  {
+    snprintf(label, sizeof(label), "%.*f", m_decimals, sample(head - 1));
+  }
+  if (m_drawn && strcmp(label, m_valueLabel) == 0)
+  {
+    return;
+  }
+  strcpy(m_valueLabel, label);
+
+  // Right aligned on the label row, so clearing the wider of the old and new text is enough.
+  m_display->setFont(font_item_value);
+  u_int16_t width = m_display->getStringWidth(m_valueLabel);
+  u_int16_t clear = width > m_valueWidth ? width : m_valueWidth;
+  int16_t right = m_display->getWidth() - PAGE_ITEM_DRAW_X_MARGIN;
+  if (m_drawn)
+  {
+    m_display->setColor(BLACK);
+    m_display->fillRect(right - clear, 1, clear, PAGE_ITEM_DRAW_HEIGHT - 1);
+    m_display->setColor(WHITE);
+  }
+  m_display->setTextAlignment(TEXT_ALIGN_RIGHT);
+  m_display->drawString(right, 0, m_valueLabel);
+  m_valueWidth = width;
+}
+
+void GraphItem::draw(u_int16_t idx)
+{
+  u_int32_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+  float min;
+  float max;
+  scale(head, plotRect().w, min, max);
+
+  // Called on a cleared frame: everything is drawn.
+  m_drawn = false;
+  m_display->setFont(font_item_label);
+  m_display->setTextAlignment(TEXT_ALIGN_LEFT);
+  m_display->drawString(PAGE_ITEM_DRAW_X_MARGIN, 0, m_label);
+  drawValueLabel(head);
+  drawScaleLabels(min, max);
+  drawPlot(head, min, max);
+
+  m_drawn = true;
+  m_drawnHead = head;
+  m_drawnMin = min;
+  m_drawnMax = max;
+}
+
+void GraphItem::drawUpdate(u_int16_t idx)
+{
+  u_int32_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+  if (!m_drawn || head == m_drawnHead)
+  {
+    return;
+  }
+
+  TransitionRect plot = plotRect();
+  float min;
+  float max;
+  scale(head, plot.w, min, max);
+  drawValueLabel(head);
+  drawScaleLabels(min, max);
+
+  u_int32_t added = head - m_drawnHead;
+  // Past m_capacity samples behind, the slots not drawn yet have been overwritten: redraw what is left.
+  if (min != m_drawnMin || max != m_drawnMax || added >= (u_int32_t)plot.w || added >= m_capacity)
+  {
+    drawPlot(head, min, max); // new scale: every column moves
+  }
+  else
+  {
+    if (m_mode == GRAPH_SCROLL)
+    {
+      shiftLeft(m_display, plot, added);
+    }
+    int16_t previousY = m_lastY;
+    for (u_int32_t i = m_drawnHead; i < head; i++)
+    {
+      int16_t x = m_mode == GRAPH_SWEEP ? plot.x + i % plot.w : plot.x + plot.w - (head - i);
+      int16_t y = plotY(sample(i), min, max, plot);
+      if (m_mode == GRAPH_SWEEP)
+      {
+        // Clear the column being overwritten and leave a one column gap ahead of the cursor.
+        int16_t gap = plot.x + (i + 1) % plot.w;
+        m_display->setColor(BLACK);
+        m_display->drawVerticalLine(x, plot.y, plot.h);
+        m_display->drawVerticalLine(gap, plot.y, plot.h);
+        m_display->setColor(WHITE);
+        previousY = x == plot.x ? y : previousY;
+      }
+      int16_t top = y < previousY ? y : previousY;
+      m_display->drawVerticalLine(x, top, (y < previousY ? previousY - y : y - previousY) + 1);
+      previousY = y;
+    }
+    m_lastY = previousY;
+  }
+
+  m_drawnHead = head;
+  m_drawnMin = min;
+  m_drawnMax = max;
+}
+
+void GraphItem::drawHighlight(u_int16_t idx)
+{
+  drawValueHighlight(idx);
+}
+
+void GraphItem::drawValueHighlight(u_int16_t idx)
+{
+  TransitionRect plot = plotRect();
+  m_display->drawRect(plot.x - 1, plot.y - 1, plot.w + 2, plot.h + 2);
+}
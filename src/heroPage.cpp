@@ -9,6 +9,7 @@ HeroPage::HeroPage(const unsigned char *icon)
 void HeroPage::addItem(HeroPageItem &pageItem)
 {
   m_currentItem = &pageItem;
+  item_attach(pageItem, 0);
   item_syncDisplay(pageItem);
 }
 
@@ -22,44 +23,10 @@ void HeroPage::reset()
 {
 }
 
-void HeroPage::onPageEvent(Event &event)
+void HeroPage::onItemInput(Event &event)
 {
-  DEBUG_SIMPLEUI("HeroPage::onPageEvent:Event: %d %lu\n", event.eventId, event.value);
-  m_context = ITEM;
-  onItemEvent(event); // There is no rotary events in hero page
-}
-
-void HeroPage::onItemEvent(Event &event)
-{
-  DEBUG_SIMPLEUI("HeroPage::onItemEvent:Event: %d %lu\n", event.eventId, event.value);
-  if (m_currentItem == nullptr)
-  {
-    DEBUG_SIMPLEUI("HeroPage::onPush ITEM -> NONE\n");
-    m_context = NONE;
-    return;
-  }
-
-  switch (event.value)
-  {
-  case ROTARY_EVENT_CW:
-  case ROTARY_EVENT_CCW:
-    item_onEvent(*m_currentItem, event);
-    break;
-  case ROTARY_EVENT_PUSH:
-    if (m_enableSaveActions)
-    {
-      DEBUG_SIMPLEUI("HeroPage::onPush ITEM -> SAVE\n");
-      m_context = SAVE;
-    }
-    else
-    {
-      DEBUG_SIMPLEUI("HeroPage::onPush ITEM -> NONE\n");
-      m_context = NONE;
-    }
-    break;
-  default:
-    break;
-  }
+  DEBUG_SIMPLEUI("HeroPage::onItemInput:Event: %d %lu\n", event.eventId, event.value);
+  item_edit(*m_currentItem, event);
 }
 
 void HeroPage::drawItems()
@@ -77,6 +44,14 @@ void HeroPage::drawItems()
   }
 }
 
+void HeroPage::drawUpdate()
+{
+  if (m_currentItem && m_currentItem->isEnabled())
+  {
+    item_drawUpdate(*m_currentItem, 0);
+  }
+}
+
 void HeroPage::syncDisplay()
 {
   if (m_currentItem)
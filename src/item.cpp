@@ -4,10 +4,29 @@ Item::Item(const char *label, void (*valueChangeResponder)(Item *item, const Eve
     : m_label(label),
       m_display(nullptr),
       onValueChange(valueChangeResponder),
-      m_enabled(true)
+      m_enabled(true),
+      m_owner(nullptr),
+      m_position(0)
 {
 }
 
+void Item::setEnabled(bool enabled)
+{
+  m_enabled = enabled;
+  if (m_owner)
+  {
+    m_owner->onItemEnabledChanged(m_position, enabled);
+  }
+}
+
+void Item::requestUpdate()
+{
+  if (m_owner)
+  {
+    m_owner->requestUpdate();
+  }
+}
+
 void Item::onEvent(Event &event)
 {
   // We can't be picky on event types here, just forward events to responder.
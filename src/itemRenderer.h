@@ -0,0 +1,85 @@
+#ifndef Futojin_ITEM_RENDERER_H
+#define Futojin_ITEM_RENDERER_H
+
+#include "display.h"
+#include "fonts.h"
+#include "transition.h"
+
+// Drawing routines shared by the virtual items (PageItem, HeroPageItem) and their static counterparts
+// (StaticPageItem, StaticHeroPageItem). Kept inline so the static path can fold them into the page.
+
+#define LIST_PAGE_DRAW_SIZE 3 // TODO: items size is hardcoded to 3. Use screen size.
+#define PAGE_ITEM_DRAW_X_MARGIN 3
+#define PAGE_ITEM_DRAW_HEIGHT 13
+#define HERO_ITEM_DRAW_LABEL_HEIGHT 19
+#define HERO_ITEM_DRAW_VALUE_HEIGHT 28
+
+struct PageItemRenderer
+{
+  static inline void draw(SimpleUIDisplay *display, u_int16_t idx, const char *label, const char *value)
+  {
+    int16_t y = idx * PAGE_ITEM_DRAW_HEIGHT;
+
+    display->setFont(font_item_label);
+    display->setTextAlignment(TEXT_ALIGN_LEFT);
+    display->drawString(PAGE_ITEM_DRAW_X_MARGIN, y, label);
+
+    display->setFont(font_item_value);
+    display->setTextAlignment(TEXT_ALIGN_RIGHT);
+    display->drawString(display->getWidth() - PAGE_ITEM_DRAW_X_MARGIN, y, value);
+  }
+
+  static inline TransitionRect highlightRect(SimpleUIDisplay *display, u_int16_t idx)
+  {
+    int16_t y = idx * PAGE_ITEM_DRAW_HEIGHT + 1; // +1 for border
+    int16_t x = 1;
+    TransitionRect rect = {x, y, (int16_t)(display->getWidth() - 2), PAGE_ITEM_DRAW_HEIGHT - 1}; //-2 for border
+    return rect;
+  }
+
+  // Area the rows of a list page scroll in, inside the border.
+  static inline TransitionRect viewport(SimpleUIDisplay *display)
+  {
+    TransitionRect rect = {1, 1, (int16_t)(display->getWidth() - 2), LIST_PAGE_DRAW_SIZE * PAGE_ITEM_DRAW_HEIGHT - 1};
+    return rect;
+  }
+
+  static inline void drawHighlight(SimpleUIDisplay *display, u_int16_t idx)
+  {
+    TransitionRect rect = highlightRect(display, idx);
+    display->drawRect(rect.x, rect.y, rect.w, rect.h);
+  }
+
+  static inline void drawValueHighlight(SimpleUIDisplay *display, u_int16_t idx, const char *value)
+  {
+    int16_t y = idx * PAGE_ITEM_DRAW_HEIGHT + 1; // +1 for border
+    display->setFont(font_item_value);
+    int16_t textWidth = display->getStringWidth(value);
+    int16_t x = display->getWidth() - PAGE_ITEM_DRAW_X_MARGIN - textWidth - 2;            // -1 for border, -1 for padding
+    display->drawRect(x, y, textWidth + PAGE_ITEM_DRAW_X_MARGIN, PAGE_ITEM_DRAW_HEIGHT - 1); // -1 for border
+  }
+};
+
+struct HeroPageItemRenderer
+{
+  static inline void draw(SimpleUIDisplay *display, const char *label, const char *value)
+  {
+    display->setFont(font_hero_label);
+    display->setTextAlignment(TEXT_ALIGN_CENTER);
+    display->drawString(display->getWidth() / 2, 0, label);
+
+    display->setFont(font_hero_value);
+    display->drawString(display->getWidth() / 2, HERO_ITEM_DRAW_LABEL_HEIGHT, value);
+  }
+
+  static inline void drawValueHighlight(SimpleUIDisplay *display, const char *value)
+  {
+    display->setFont(font_hero_value);
+    uint16_t textWidth = display->getStringWidth(value);
+    int16_t x = (display->getWidth() / 2 - textWidth / 2) - 2; // -2 padding
+    int16_t y = HERO_ITEM_DRAW_LABEL_HEIGHT;
+    display->drawRect(x, y, textWidth + 4, HERO_ITEM_DRAW_VALUE_HEIGHT); // +2 padding
+  }
+};
+
+#endif // Futojin_ITEM_RENDERER_H
@@ -1,16 +1,25 @@
 #include "simpleUI.h"
-
-#define DRAW_LIST_SIZE 3 // TODO: items size is hardcoded to 3. Use screen size.
+#include "itemRenderer.h"
 
 void ListPage::addItem(PageItem &item)
 {
+  item_attach(item, m_pageItems.size());
   m_pageItems.push_back(&item);
+  m_enabledItems.push_back(item.isEnabled());
   item_syncDisplay(item);
+}
 
-  if (m_pageItems.size() == 1)
-  {
-    m_currentItemIt = m_pageItems.begin();
-  }
+void ListPage::onItemEnabledChanged(u_int16_t position, bool enabled)
+{
+  m_enabledItems.set(position, enabled);
+}
+
+// Aim to have the currentItem in the middle of the screen, if possible. Ranks only count enabled items,
+// so the window is found without walking over disabled ones.
+size_t ListPage::firstVisibleRank() const
+{
+  size_t currentRank = m_enabledItems.rank(m_currentIdx);
+  return currentRank > (LIST_PAGE_DRAW_SIZE / 2) ? currentRank - (LIST_PAGE_DRAW_SIZE / 2) : 0;
 }
 
 void ListPage::drawItems()
@@ -20,46 +29,18 @@ void ListPage::drawItems()
     return; // Nothing to draw
   }
   DEBUG_SIMPLEUI("Page::drawItems\n");
-
-  // Collect enabled items to draw
-  std::vector<Item *> enabledItems;
-
-  // First, collect previous enabled items with aim to have the currentItem in the middle of the screen, if possible
-  auto prevIt = m_currentItemIt;
-  while (prevIt != m_pageItems.begin() && enabledItems.size() < (DRAW_LIST_SIZE / 2))
-  {
-    --prevIt;
-    if ((*prevIt)->isEnabled())
-    {
-      enabledItems.insert(enabledItems.begin(), *prevIt);
-    }
-  }
-
-  // Add current item if enabled
-  if ((*m_currentItemIt)->isEnabled())
-  {
-    enabledItems.push_back(*m_currentItemIt);
-  }
-
-  // Find next enabled items if we have space
-  auto nextIt = m_currentItemIt;
-  while (nextIt != m_pageItems.end() && enabledItems.size() < DRAW_LIST_SIZE)
-  {
-    ++nextIt;
-    if (nextIt != m_pageItems.end() && (*nextIt)->isEnabled())
-    {
-      enabledItems.push_back(*nextIt);
-    }
-  }
+  size_t firstRank = firstVisibleRank();
 
   // Draw the enabled items
   int drawIdx = 0;
-  for (Item *item : enabledItems)
+  for (size_t rank = firstRank; rank < m_enabledItems.count() && drawIdx < LIST_PAGE_DRAW_SIZE; rank++)
   {
+    size_t idx = m_enabledItems.select(rank);
+    Item *item = m_pageItems[idx];
     DEBUG_SIMPLEUI("Page::drawItem: %s\n", item->m_label);
     item_draw(*item, drawIdx);
 
-    if (item == *m_currentItemIt)
+    if (idx == m_currentIdx)
     {
       if (m_context == PAGE)
       {
@@ -77,64 +58,9 @@ void ListPage::drawItems()
   }
 }
 
-void ListPage::onPageEvent(Event &event)
+void ListPage::onItemInput(Event &event)
 {
-  if (event.value == ROTARY_EVENT_CW)
-  {
-    bool next = nextItem();
-    if (next)
-    {
-      DEBUG_SIMPLEUI("Page::onEvent: PAGE CW m_currentIdx: %s\n", (*m_currentItemIt)->m_label);
-    }
-    else if (m_enableSaveActions) // we don't have next item, but we can overflow to save actions
-    {
-      DEBUG_SIMPLEUI("Page::onEvent: PAGE CW SAVE\n");
-      m_context = SAVE;
-    }
-    else // we don't have next item and can't overflow. Yield control back to container
-    {
-      DEBUG_SIMPLEUI("Page::onEvent: PAGE CW YIELD()\n");
-      m_context = NONE;
-    }
-  }
-  else if (event.value == ROTARY_EVENT_CCW)
-  {
-    bool prev = prevItem();
-    if (prev)
-    {
-      DEBUG_SIMPLEUI("Page::onEvent: PAGE CCW m_currentIdx: %s\n", (*m_currentItemIt)->m_label);
-    }
-    else if (m_enableSaveActions) // we don't have previous item, but we can overflow to save actions
-    {
-      DEBUG_SIMPLEUI("Page::onEvent: PAGE CCW SAVE\n");
-      m_context = SAVE;
-    }
-  }
-  else if (event.value == ROTARY_EVENT_PUSH)
-  {
-    if (!m_pageItems.empty())
-    {
-      DEBUG_SIMPLEUI("Page::onPush PAGE -> ITEM\n");
-      m_context = ITEM;
-    }
-  }
-}
-
-void ListPage::onItemEvent(Event &event)
-{
-  switch (event.value)
-  {
-  case ROTARY_EVENT_CW:
-  case ROTARY_EVENT_CCW:
-    item_onEvent(**m_currentItemIt, event);
-    break;
-  case ROTARY_EVENT_PUSH:
-    DEBUG_SIMPLEUI("Page::onPush ITEM -> PAGE\n");
-    m_context = PAGE;
-    break;
-  default:
-    break;
-  }
+  item_edit(*m_pageItems[m_currentIdx], event);
 }
 
 void ListPage::syncDisplay()
@@ -156,60 +82,57 @@ void ListPage::start()
 
 bool ListPage::nextItem()
 {
-  if (m_pageItems.empty())
+  size_t nextIdx = m_enabledItems.next(m_currentIdx);
+  if (nextIdx == EnabledIndex::npos)
   {
+    // No enabled item found after current position
     return false;
   }
+  m_currentIdx = nextIdx;
+  return true;
+}
 
-  // Current iterator is already at end
-  if (m_currentItemIt == m_pageItems.end())
+bool ListPage::prevItem()
+{
+  size_t prevIdx = m_enabledItems.prev(m_currentIdx);
+  if (prevIdx == EnabledIndex::npos)
   {
+    // No enabled item found before current position
     return false;
   }
+  m_currentIdx = prevIdx;
+  return true;
+}
 
-  std::list<PageItem *>::iterator nextIt = m_currentItemIt;
-  do
-  {
-    ++nextIt;
-    if (nextIt != m_pageItems.end() && (*nextIt)->isEnabled())
-    {
-      m_currentItemIt = nextIt;
-      return true;
-    }
-  } while (nextIt != m_pageItems.end());
-
-  // No enabled item found after current position
-  return false;
+void ListPage::reset()
+{
+  m_currentIdx = 0;
 }
 
-bool ListPage::prevItem()
+bool ListPage::restoreCursor(u_int32_t cursor)
 {
-  if (m_pageItems.empty())
+  if (cursor != 0 && (cursor >= m_pageItems.size() || !m_pageItems[cursor]->isEnabled()))
   {
     return false;
   }
+  m_currentIdx = cursor;
+  return true;
+}
 
-  if (m_currentItemIt == m_pageItems.begin())
-  {
-    return false; // Already at beginning
-  }
-
-  std::list<PageItem *>::iterator prevIt = m_currentItemIt;
-  do
-  {
-    --prevIt;
-    if ((*prevIt)->isEnabled())
-    {
-      m_currentItemIt = prevIt;
-      return true;
-    }
-  } while (prevIt != m_pageItems.begin());
-
-  // No enabled item found before current position
-  return false;
+size_t ListPage::heapUsage() const
+{
+  return m_pageItems.capacity() * sizeof(PageItem *) + m_enabledItems.heapUsage();
 }
 
-void ListPage::reset()
+bool ListPage::selection(PageSelection &selection) const
 {
-  m_currentItemIt = m_pageItems.begin();
+  if (m_context != PAGE || m_pageItems.empty())
+  {
+    return false;
+  }
+  size_t firstRank = firstVisibleRank();
+  selection.viewport = PageItemRenderer::viewport(m_display);
+  selection.scrollY = firstRank * PAGE_ITEM_DRAW_HEIGHT;
+  selection.highlight = PageItemRenderer::highlightRect(m_display, m_enabledItems.rank(m_currentIdx) - firstRank);
+  return true;
 }
@@ -0,0 +1,376 @@
+#include "menuDescriptor.h"
+
+// Built-in icons by id; tools/menu_compile.py keeps the same order.
+static const unsigned char *const s_menuIcons[] = {
+    icon_settings, icon_bluetooth, icon_cancel, icon_save, icon_check, icon_home, icon_back, icon_bulb, icon_power};
+#define MENU_BUILTIN_ICONS (sizeof(s_menuIcons) / sizeof(s_menuIcons[0]))
+
+static bool tableInside(u_int32_t offset, u_int32_t count, u_int32_t recordSize, u_int32_t end)
+{
+  return (u_int64_t)offset + (u_int64_t)count * recordSize <= end;
+}
+
+DescriptorPage::DescriptorPage()
+    : VirtualListPage(nullptr, *this, 0), // no cache: rows are read from the descriptor in place
+      m_menu(nullptr),
+      m_firstItem(0),
+      m_itemCount(0)
+{
+  m_valueText[0] = '\0';
+}
+
+const char *DescriptorPage::label(size_t row)
+{
+  return m_menu->label(m_firstItem + row);
+}
+
+const char *DescriptorPage::value(size_t row)
+{
+  return m_menu->valueText(m_firstItem + row, m_valueText, sizeof(m_valueText));
+}
+
+void DescriptorPage::onRowEvent(size_t row, const Event *event)
+{
+  m_menu->onItemEvent(m_firstItem + row, event);
+}
+
+DescriptorMenu::DescriptorMenu(int32_t *values, size_t capacity, const MenuCallback *callbacks, size_t callbackCount, void *arg)
+    : m_values(values),
+      m_capacity(capacity),
+      m_callbacks(callbacks),
+      m_callbackCount(callbacks ? callbackCount : 0),
+      m_arg(arg),
+      m_data(nullptr),
+      m_header(nullptr),
+      m_error(MENU_DESCRIPTOR_OK)
+#ifdef ESP_PLATFORM
+      ,
+      m_mmapHandle(0),
+      m_mapped(false)
+#endif
+{
+}
+
+DescriptorMenu::~DescriptorMenu()
+{
+  unload();
+}
+
+void DescriptorMenu::unload()
+{
+  m_data = nullptr;
+  m_header = nullptr;
+#ifdef ESP_PLATFORM
+  if (m_mapped)
+  {
+    esp_partition_munmap(m_mmapHandle);
+    m_mapped = false;
+  }
+#endif
+}
+
+bool DescriptorMenu::load(const uint8_t *data, size_t size)
+{
+  unload(); // a partition mapped by an earlier loadPartition()
+  return use(data, size);
+}
+
+#ifdef ESP_PLATFORM
+bool DescriptorMenu::loadPartition(const char *label)
+{
+  unload();
+  const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  const void *data = nullptr;
+  if (partition == nullptr ||
+      esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &m_mmapHandle) != ESP_OK)
+  {
+    m_error = MENU_DESCRIPTOR_TRUNCATED;
+    return false;
+  }
+  m_mapped = true;
+  if (!use((const uint8_t *)data, partition->size))
+  {
+    unload();
+    return false;
+  }
+  return true;
+}
+#endif
+
+// Checks data and uses it in place; the caller unloaded the previous descriptor.
+bool DescriptorMenu::use(const uint8_t *data, size_t size)
+{
+  m_data = data;
+  m_header = (const MenuDescriptorHeader *)data;
+  m_error = validate(size);
+  if (m_error != MENU_DESCRIPTOR_OK)
+  {
+    DEBUG_SIMPLEUI("DescriptorMenu::load: rejected: %d\n", m_error);
+    m_data = nullptr;
+    m_header = nullptr;
+    return false;
+  }
+  for (size_t i = 0; i < m_header->itemCount; i++)
+  {
+    m_values[i] = itemRecord(i).initial;
+  }
+  return true;
+}
+
+// Checks everything later reads rely on, so drawing and input never check offsets again.
+MENU_DESCRIPTOR_ERROR DescriptorMenu::validate(size_t size) const
+{
+  if (m_data == nullptr || size < sizeof(MenuDescriptorHeader))
+  {
+    return MENU_DESCRIPTOR_TRUNCATED;
+  }
+  if ((uintptr_t)m_data % 4 != 0)
+  {
+    return MENU_DESCRIPTOR_ALIGNMENT;
+  }
+  const MenuDescriptorHeader &header = *m_header;
+  if (header.magic != MENU_DESCRIPTOR_MAGIC)
+  {
+    return MENU_DESCRIPTOR_MAGIC_BAD;
+  }
+  if (header.version >> 8 != MENU_DESCRIPTOR_VERSION_MAJOR || header.headerSize < sizeof(MenuDescriptorHeader) ||
+      header.pageRecordSize < sizeof(MenuPageRecord) || header.itemRecordSize < sizeof(MenuItemRecord) ||
+      header.pageRecordSize % 4 != 0 || header.itemRecordSize % 4 != 0)
+  {
+    return MENU_DESCRIPTOR_VERSION;
+  }
+  if (header.size > size || header.size < (u_int32_t)header.headerSize + 4)
+  {
+    return MENU_DESCRIPTOR_TRUNCATED;
+  }
+  u_int32_t end = header.size - 4;
+  u_int32_t crc;
+  memcpy(&crc, m_data + end, sizeof(crc));
+  if (snapshotCrc32(m_data, end) != crc)
+  {
+    return MENU_DESCRIPTOR_CHECKSUM;
+  }
+
+  if (header.pagesOffset % 4 != 0 || header.itemsOffset % 4 != 0)
+  {
+    return MENU_DESCRIPTOR_ALIGNMENT;
+  }
+  if (!tableInside(header.pagesOffset, header.pageCount, header.pageRecordSize, end) ||
+      !tableInside(header.itemsOffset, header.itemCount, header.itemRecordSize, end) ||
+      !tableInside(header.iconsOffset, header.iconCount, MENU_ICON_BYTES, end) ||
+      !tableInside(header.stringsOffset, header.stringsSize, 1, end) || header.stringsSize > MENU_NO_STRING)
+  {
+    return MENU_DESCRIPTOR_TABLE;
+  }
+  if (header.pageCount > SIMPLEUI_MENU_MAX_PAGES || header.itemCount > m_capacity)
+  {
+    return MENU_DESCRIPTOR_CAPACITY;
+  }
+
+  for (size_t i = 0; i < header.pageCount; i++)
+  {
+    const MenuPageRecord &page = pageRecord(i);
+    if (page.kind >= MENU_PAGE_KIND_COUNT || icon(page.icon) == nullptr ||
+        (u_int32_t)page.firstItem + page.itemCount > header.itemCount)
+    {
+      return MENU_DESCRIPTOR_PAGE;
+    }
+  }
+
+  for (size_t i = 0; i < header.itemCount; i++)
+  {
+    const MenuItemRecord &item = itemRecord(i);
+    if (!validString(item.label) || (item.key != MENU_NO_STRING && !validString(item.key, SETTINGS_KEY_SIZE - 1)))
+    {
+      return MENU_DESCRIPTOR_STRING;
+    }
+    bool range = item.min <= item.max && item.initial >= item.min && item.initial <= item.max;
+    switch (item.type)
+    {
+    case MENU_ITEM_INT:
+      range = range && item.step > 0;
+      break;
+    case MENU_ITEM_BOOL:
+      range = range && item.min == 0 && item.max == 1;
+      break;
+    case MENU_ITEM_ENUM:
+      range = range && item.step > 0 && item.options != MENU_NO_STRING;
+      break;
+    default:
+      return MENU_DESCRIPTOR_ITEM;
+    }
+    if (!range || (item.callback != MENU_NO_CALLBACK && item.callback >= m_callbackCount))
+    {
+      return MENU_DESCRIPTOR_ITEM;
+    }
+    if (item.type == MENU_ITEM_ENUM)
+    {
+      u_int32_t offset = item.options;
+      for (int64_t option = item.min; option <= item.max; option++)
+      {
+        if (offset > MENU_NO_STRING || !validString(offset))
+        {
+          return MENU_DESCRIPTOR_STRING;
+        }
+        offset += strlen(string(offset)) + 1;
+      }
+    }
+  }
+  return MENU_DESCRIPTOR_OK;
+}
+
+bool DescriptorMenu::validString(u_int16_t offset, size_t maxLength) const
+{
+  if (offset >= m_header->stringsSize)
+  {
+    return false;
+  }
+  const char *start = (const char *)m_data + m_header->stringsOffset + offset;
+  const char *terminator = (const char *)memchr(start, '\0', m_header->stringsSize - offset);
+  return terminator != nullptr && (size_t)(terminator - start) <= maxLength;
+}
+
+const MenuPageRecord &DescriptorMenu::pageRecord(size_t index) const
+{
+  return *(const MenuPageRecord *)(m_data + m_header->pagesOffset + index * m_header->pageRecordSize);
+}
+
+const MenuItemRecord &DescriptorMenu::itemRecord(size_t index) const
+{
+  return *(const MenuItemRecord *)(m_data + m_header->itemsOffset + index * m_header->itemRecordSize);
+}
+
+const char *DescriptorMenu::string(u_int16_t offset) const
+{
+  return (const char *)m_data + m_header->stringsOffset + offset;
+}
+
+const unsigned char *DescriptorMenu::icon(u_int16_t id) const
+{
+  if (id < MENU_BUILTIN_ICONS)
+  {
+    return s_menuIcons[id];
+  }
+  if (id >= MENU_ICON_CUSTOM && id - MENU_ICON_CUSTOM < m_header->iconCount)
+  {
+    return m_data + m_header->iconsOffset + (id - MENU_ICON_CUSTOM) * MENU_ICON_BYTES;
+  }
+  return nullptr;
+}
+
+const char *DescriptorMenu::label(u_int16_t item) const
+{
+  return string(itemRecord(item).label);
+}
+
+// Option names and ON/OFF are returned in place; only numbers are formatted, into buffer.
+const char *DescriptorMenu::valueText(u_int16_t item, char *buffer, size_t size) const
+{
+  const MenuItemRecord &record = itemRecord(item);
+  int32_t value = m_values[item];
+  if (value < record.min || value > record.max)
+  {
+    return "?"; // set from outside, e.g. settings saved by another menu
+  }
+  switch (record.type)
+  {
+  case MENU_ITEM_BOOL:
+    return value ? "ON" : "OFF";
+  case MENU_ITEM_ENUM:
+  {
+    const char *option = string(record.options);
+    for (int32_t i = record.min; i < value; i++)
+    {
+      option += strlen(option) + 1;
+    }
+    return option;
+  }
+  default:
+    snprintf(buffer, size, "%ld", (long)value);
+    return buffer;
+  }
+}
+
+void DescriptorMenu::setValue(u_int16_t item, int32_t value)
+{
+  const MenuItemRecord &record = itemRecord(item);
+  m_values[item] = value < record.min ? record.min : (value > record.max ? record.max : value);
+}
+
+void DescriptorMenu::onItemEvent(u_int16_t item, const Event *event)
+{
+  const MenuItemRecord &record = itemRecord(item);
+  if (event->eventId != EVENT_ROT || event->value == ROTARY_EVENT_PUSH || (record.flags & MENU_ITEM_READONLY))
+  {
+    return;
+  }
+  int64_t value = m_values[item];
+  value = value < record.min ? record.min : (value > record.max ? record.max : value);
+  if (record.type == MENU_ITEM_BOOL)
+  {
+    value = !value;
+  }
+  else
+  {
+    value += event->value == ROTARY_EVENT_CW ? record.step : -(int64_t)record.step;
+    bool wrap = record.flags & MENU_ITEM_WRAP;
+    if (value > record.max)
+    {
+      value = wrap ? record.min : record.max;
+    }
+    else if (value < record.min)
+    {
+      value = wrap ? record.max : record.min;
+    }
+  }
+  if (value == m_values[item])
+  {
+    return;
+  }
+  m_values[item] = value;
+  if (record.callback != MENU_NO_CALLBACK)
+  {
+    m_callbacks[record.callback](item, m_values[item], m_arg);
+  }
+}
+
+void DescriptorMenu::addPages(Container &container, SettingsStore *settings)
+{
+  for (size_t i = 0; i < pageCount(); i++)
+  {
+    const MenuPageRecord &record = pageRecord(i);
+    DescriptorPage &page = m_pages[i];
+    page.m_menu = this;
+    page.m_firstItem = record.firstItem;
+    page.m_itemCount = record.itemCount;
+    page.m_icon = icon(record.icon);
+    if (settings && (record.flags & MENU_PAGE_SAVE_ACTIONS))
+    {
+      page.enableSaveActions(*settings);
+    }
+    else
+    {
+      page.bindSettings(settings);
+    }
+    container.addPage(page);
+  }
+  if (settings)
+  {
+    // Owned by their page, so exit on one page leaves the values of the others alone.
+    for (size_t i = 0; i < itemCount(); i++)
+    {
+      const MenuItemRecord &record = itemRecord(i);
+      if (record.key == MENU_NO_STRING)
+      {
+        continue;
+      }
+      const Page *owner = nullptr; // the address Page::discardEdits() reverts by
+      for (size_t p = 0; p < pageCount() && owner == nullptr; p++)
+      {
+        const MenuPageRecord &page = pageRecord(p);
+        owner = i >= page.firstItem && i < (size_t)page.firstItem + page.itemCount ? &m_pages[p] : nullptr;
+      }
+      settings->bind(string(record.key), m_values[i], owner);
+    }
+  }
+}
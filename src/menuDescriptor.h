@@ -0,0 +1,215 @@
+#ifndef Futojin_MENU_DESCRIPTOR_H
+#define Futojin_MENU_DESCRIPTOR_H
+
+#include "simpleUI.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+#endif
+
+// Menus described by data instead of addPage()/addItem() calls, so one firmware serves different menus.
+// tools/menu_compile.py turns a text description into a binary descriptor. The firmware uses it in place,
+// from a const array or a memory-mapped flash partition: pages, labels, option names and icons are read
+// from the descriptor on every draw, and only the current values live in RAM.
+//
+// Layout, little endian, every table 4-byte aligned:
+//
+//   MenuDescriptorHeader
+//   pages    pageCount records of pageRecordSize bytes  (MenuPageRecord)
+//   items    itemCount records of itemRecordSize bytes  (MenuItemRecord, in page order)
+//   icons    iconCount XBM images of MENU_ICON_BYTES bytes
+//   strings  NUL-terminated labels, settings keys and option names, referenced by offset
+//   CRC-32 of everything before it
+//
+// The major version changes when a reader can no longer make sense of the data. Minor versions only
+// append fields to the header or the records: the record sizes in the header let older readers skip them.
+
+#define MENU_DESCRIPTOR_MAGIC 0x444D5553 // "SUMD"
+#define MENU_DESCRIPTOR_VERSION_MAJOR 1
+#define MENU_DESCRIPTOR_VERSION_MINOR 0
+#define MENU_NO_STRING 0xFFFF
+#define MENU_NO_CALLBACK 0xFFFF
+#define MENU_ICON_CUSTOM 0x100 // icon ids from here on index the descriptor's icons, below the built-in ones
+#define MENU_ICON_BYTES ((ICON_SIZE + 7) / 8 * ICON_SIZE)
+
+#ifndef SIMPLEUI_MENU_MAX_PAGES
+#define SIMPLEUI_MENU_MAX_PAGES 8
+#endif
+
+struct MenuDescriptorHeader
+{
+  u_int32_t magic;
+  u_int16_t version; // major << 8 | minor
+  u_int16_t headerSize;
+  u_int32_t size; // bytes, CRC included
+  u_int16_t pageCount;
+  u_int16_t itemCount;
+  u_int16_t iconCount;
+  u_int8_t pageRecordSize;
+  u_int8_t itemRecordSize;
+  u_int32_t pagesOffset;
+  u_int32_t itemsOffset;
+  u_int32_t iconsOffset;
+  u_int32_t stringsOffset;
+  u_int32_t stringsSize;
+};
+
+enum MENU_PAGE_KIND
+{
+  MENU_PAGE_LIST, // a VirtualListPage over the page's items
+  MENU_PAGE_KIND_COUNT
+};
+
+#define MENU_PAGE_SAVE_ACTIONS 0x01 // save and exit icons, see DescriptorMenu::addPages()
+
+struct MenuPageRecord
+{
+  u_int16_t icon; // built-in icon (see s_menuIcons), or MENU_ICON_CUSTOM + index
+  u_int16_t firstItem;
+  u_int16_t itemCount;
+  u_int8_t kind;  // MENU_PAGE_KIND
+  u_int8_t flags; // MENU_PAGE_*
+};
+
+enum MENU_ITEM_TYPE
+{
+  MENU_ITEM_INT,  // min to max, in steps of step
+  MENU_ITEM_BOOL, // 0 or 1, shown as OFF and ON; any turn toggles it
+  MENU_ITEM_ENUM, // min to max, shown as the option names at options
+  MENU_ITEM_TYPE_COUNT
+};
+
+#define MENU_ITEM_WRAP 0x01     // turning past one end of the range continues at the other one
+#define MENU_ITEM_READONLY 0x02 // shown, set by the application only
+
+struct MenuItemRecord
+{
+  u_int16_t label;    // string offset
+  u_int16_t key;      // settings key, or MENU_NO_STRING
+  u_int16_t options;  // MENU_ITEM_ENUM: max - min + 1 consecutive strings, or MENU_NO_STRING
+  u_int16_t callback; // index in the callback table, or MENU_NO_CALLBACK
+  u_int8_t type;      // MENU_ITEM_TYPE
+  u_int8_t flags;     // MENU_ITEM_*
+  u_int16_t reserved;
+  int32_t min;
+  int32_t max;
+  int32_t step;
+  int32_t initial;
+};
+
+static_assert(sizeof(MenuDescriptorHeader) == 40, "descriptor header layout");
+static_assert(sizeof(MenuPageRecord) == 8, "descriptor page record layout");
+static_assert(sizeof(MenuItemRecord) == 28, "descriptor item record layout");
+
+enum MENU_DESCRIPTOR_ERROR
+{
+  MENU_DESCRIPTOR_OK,
+  MENU_DESCRIPTOR_TRUNCATED,  // shorter than its header or its size field
+  MENU_DESCRIPTOR_ALIGNMENT,  // data or a table not 4-byte aligned
+  MENU_DESCRIPTOR_MAGIC_BAD,  // not a descriptor
+  MENU_DESCRIPTOR_VERSION,    // major version not supported, or records smaller than this version's
+  MENU_DESCRIPTOR_CHECKSUM,
+  MENU_DESCRIPTOR_TABLE,      // a table outside the descriptor
+  MENU_DESCRIPTOR_CAPACITY,   // more pages than SIMPLEUI_MENU_MAX_PAGES or items than value slots
+  MENU_DESCRIPTOR_PAGE,       // unknown kind or icon, or items outside the item table
+  MENU_DESCRIPTOR_ITEM,       // unknown type, empty range, or callback outside the callback table
+  MENU_DESCRIPTOR_STRING      // offset outside the string table, unterminated string, or key too long
+};
+
+// Called after an item's value changed through the encoder.
+typedef void (*MenuCallback)(u_int16_t item, int32_t value, void *arg);
+
+class DescriptorMenu;
+
+// List page over the items of one descriptor page. Rows are read from the descriptor, nothing is cached.
+class DescriptorPage : private ListDataSource, public VirtualListPage
+{
+  friend class DescriptorMenu;
+
+public:
+  DescriptorPage();
+
+private:
+  DescriptorMenu *m_menu;
+  u_int16_t m_firstItem;
+  u_int16_t m_itemCount;
+  char m_valueText[12]; // formatted MENU_ITEM_INT value, valid until the next call
+
+  size_t count() override { return m_itemCount; }
+  const char *label(size_t row) override;
+  const char *value(size_t row) override;
+  void onRowEvent(size_t row, const Event *event) override;
+};
+
+/**
+ * A menu running from a binary descriptor, see menuDescriptor.h. values holds one int32_t per item, so
+ * capacity bounds the item count of the descriptors this firmware accepts. Callback ids of the
+ * descriptor index callbacks.
+ *
+ *   DescriptorMenu menu(values, MAX_ITEMS, callbacks, CALLBACK_COUNT);
+ *   if (menu.load(menuData, sizeof(menuData)))
+ *   {
+ *     menu.addPages(container, &settings);
+ *     settings.load();
+ *   }
+ *
+ * load() validates the whole descriptor once; later reads use it as is, so it must stay mapped and
+ * unchanged while the menu is in use.
+ */
+class DescriptorMenu
+{
+  friend class DescriptorPage;
+
+public:
+  DescriptorMenu(int32_t *values, size_t capacity, const MenuCallback *callbacks = nullptr, size_t callbackCount = 0, void *arg = nullptr);
+  ~DescriptorMenu();
+  DescriptorMenu(const DescriptorMenu &) = delete;
+  DescriptorMenu &operator=(const DescriptorMenu &) = delete;
+
+  // Checks data and sets every value to its initial one. On failure the menu is empty and error() tells why.
+  bool load(const uint8_t *data, size_t size);
+#ifdef ESP_PLATFORM
+  // Maps the data partition named label and loads the descriptor at its start.
+  bool loadPartition(const char *label);
+#endif
+  MENU_DESCRIPTOR_ERROR error() const { return m_error; }
+
+  // Adds a page per descriptor page. With settings, items with a key are bound to it (call settings.load()
+  // afterwards), pages flagged MENU_PAGE_SAVE_ACTIONS commit and revert it, other pages touch it.
+  void addPages(Container &container, SettingsStore *settings = nullptr);
+  size_t pageCount() const { return m_header ? m_header->pageCount : 0; }
+  Page &page(size_t index) { return m_pages[index]; }
+  size_t itemCount() const { return m_header ? m_header->itemCount : 0; }
+  const char *label(u_int16_t item) const;
+  int32_t value(u_int16_t item) const { return m_values[item]; }
+  // Clamps to the item's range. Shown from the next frame on.
+  void setValue(u_int16_t item, int32_t value);
+
+private:
+  int32_t *m_values;
+  size_t m_capacity;
+  const MenuCallback *m_callbacks;
+  size_t m_callbackCount;
+  void *m_arg;
+  const uint8_t *m_data;
+  const MenuDescriptorHeader *m_header;
+  MENU_DESCRIPTOR_ERROR m_error;
+  DescriptorPage m_pages[SIMPLEUI_MENU_MAX_PAGES];
+#ifdef ESP_PLATFORM
+  esp_partition_mmap_handle_t m_mmapHandle;
+  bool m_mapped;
+#endif
+
+  bool use(const uint8_t *data, size_t size);
+  MENU_DESCRIPTOR_ERROR validate(size_t size) const;
+  bool validString(u_int16_t offset, size_t maxLength = SIZE_MAX) const;
+  const MenuPageRecord &pageRecord(size_t index) const;
+  const MenuItemRecord &itemRecord(size_t index) const;
+  const char *string(u_int16_t offset) const;
+  const unsigned char *icon(u_int16_t id) const;
+  const char *valueText(u_int16_t item, char *buffer, size_t size) const;
+  void onItemEvent(u_int16_t item, const Event *event);
+  void unload();
+};
+
+#endif // Futojin_MENU_DESCRIPTOR_H
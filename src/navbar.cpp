@@ -1,68 +1,108 @@
 #include "simpleUI.h"
 
-Navbar::Navbar(SH1106Wire &display, Container &container)
+#define NAVBAR_INDICATOR_WIDTH 5
+
+Navbar::Navbar(SimpleUIDisplay &display, Container &container)
     : m_display(&display),
       m_context(NAVBAR),
       m_container(&container)
 {
 }
 
-void Navbar::draw(const Page &currentPage)
+// Only a window of icons around the current page is laid out. When there are more enabled pages than fit,
+// space is reserved on both sides for the overflow indicators.
+bool Navbar::window(Window &window) const
 {
-  DEBUG_SIMPLEUI("Navbar::draw\n");
-  if (m_context != NAVBAR)
+  const EnabledIndex &enabledPages = m_container->m_enabledPages;
+  if (m_context != NAVBAR || enabledPages.count() == 0)
   {
-    return;
+    return false;
   }
 
-  u_int16_t iconIdx = 0;
-
   // Draw on the bottom
+  int width = m_display->getWidth();
   int height = m_display->getHeight();
-  int16_t y = height - ICON_SIZE - 1; //-1 for border
+  window.y = height - ICON_SIZE - 1; //-1 for border
 
-  for (const Page *thisPage : m_pages)
+  size_t total = enabledPages.count();
+  window.slots = (width - 2) / ICON_SIZE; //-2 for border
+  window.x0 = 1;
+  window.overflow = total > window.slots;
+  if (window.overflow)
   {
-    if (!thisPage->enabled())
-    {
-      continue;
-    }
+    window.slots = (width - 2 - 2 * NAVBAR_INDICATOR_WIDTH) / ICON_SIZE;
+    window.x0 += NAVBAR_INDICATOR_WIDTH;
+  }
 
-    int16_t x = iconIdx * ICON_SIZE + 1;
-    if (thisPage == &currentPage)
+  size_t currentRank = enabledPages.rank(m_container->m_idx);
+  window.firstRank = 0;
+  if (window.overflow)
+  {
+    window.firstRank = currentRank > window.slots / 2 ? currentRank - window.slots / 2 : 0;
+    if (window.firstRank + window.slots > total)
     {
-      m_display->drawRect(x, y, ICON_SIZE, ICON_SIZE);
+      window.firstRank = total - window.slots;
     }
-    m_display->drawXbm(x, y, ICON_SIZE, ICON_SIZE, thisPage->getIcon());
-    iconIdx++;
   }
+  return true;
 }
 
-void Navbar::addPage(Page &page)
+bool Navbar::highlightRect(TransitionRect &rect) const
 {
-  m_pages.push_back(&page);
+  Window window;
+  if (!this->window(window))
+  {
+    return false;
+  }
+  size_t currentRank = m_container->m_enabledPages.rank(m_container->m_idx);
+  rect.x = window.x0 + (currentRank - window.firstRank) * ICON_SIZE;
+  rect.y = window.y;
+  rect.w = ICON_SIZE;
+  rect.h = ICON_SIZE;
+  return true;
 }
 
-void Navbar::onEvent(Event &event)
+void Navbar::draw()
 {
-  // Navbar doesn't track CW and CCW. currentPage tracking is done by Container
-  // Navbar only handle push events
-  if (event.eventId != EVENT_ROT || event.value != ROTARY_EVENT_PUSH)
+  DEBUG_SIMPLEUI("Navbar::draw\n");
+  Window window;
+  if (!this->window(window))
   {
     return;
   }
 
-  // Push event essentially toggle between NAVBAR and NONE (Page)
-  if (m_context == NONE)
+  const EnabledIndex &enabledPages = m_container->m_enabledPages;
+  size_t total = enabledPages.count();
+  for (size_t iconIdx = 0; iconIdx < window.slots && window.firstRank + iconIdx < total; iconIdx++)
   {
-    DEBUG_SIMPLEUI("Navbar::onPush: NONE -> NAVBAR\n");
-    m_context = NAVBAR;
+    size_t pageIdx = enabledPages.select(window.firstRank + iconIdx);
+    const Page *thisPage = m_container->m_pages[pageIdx];
+
+    int16_t x = window.x0 + iconIdx * ICON_SIZE;
+    if (pageIdx == m_container->m_idx)
+    {
+      m_display->drawRect(x, window.y, ICON_SIZE, ICON_SIZE);
+    }
+    m_display->drawXbm(x, window.y, ICON_SIZE, ICON_SIZE, thisPage->getIcon());
+  }
+
+  if (window.overflow && window.firstRank > 0)
+  {
+    drawOverflowIndicator(1, window.y, true);
   }
-  else if (m_context == NAVBAR)
+  if (window.overflow && window.firstRank + window.slots < total)
+  {
+    drawOverflowIndicator(m_display->getWidth() - 1 - NAVBAR_INDICATOR_WIDTH, window.y, false);
+  }
+}
+
+void Navbar::drawOverflowIndicator(int16_t x, int16_t y, bool left)
+{
+  // Small triangle, vertically centered on the icon row
+  int16_t centerY = y + ICON_SIZE / 2;
+  for (int16_t i = 0; i < NAVBAR_INDICATOR_WIDTH - 1; i++)
   {
-    m_context = NONE;
-    DEBUG_SIMPLEUI("Navbar::onPush: NAVBAR -> NONE\n");
-    Event yieldToContainer = {EVENT_YIELD, NAVBAR};
-    m_container->onEventYield(yieldToContainer);
+    int16_t column = left ? x + 1 + i : x + NAVBAR_INDICATOR_WIDTH - 2 - i;
+    m_display->drawVerticalLine(column, centerY - i, 2 * i + 1);
   }
 }
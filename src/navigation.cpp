@@ -0,0 +1,191 @@
+#include "simpleUI.h"
+
+// Entries every page kind shares: choosing a page, the save and exit icons, and NONE.
+#define NAV_GO(to) {{{NAV_ALWAYS, NAV_NO_ACTION, to}}}
+#define NAV_ROW_NONE {NAV_GO(NONE), NAV_GO(NONE), NAV_GO(PAGE)}
+#define NAV_ROW_NAVBAR                               \
+  {{{{NAV_ALWAYS, NAV_PAGE_NEXT, NAVBAR}}},          \
+   {{{NAV_ALWAYS, NAV_PAGE_PREVIOUS, NAVBAR}}},      \
+   NAV_GO(PAGE)}
+// Save actions that were disabled while selected fall back to the navbar.
+#define NAV_ROW_SAVE                                                               \
+  {{{{NAV_IF_SAVE_ACTIONS, NAV_NO_ACTION, EXIT}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}, \
+   {{{NAV_IF_SAVE_ACTIONS, NAV_NO_ACTION, PAGE}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}, \
+   {{{NAV_IF_SAVE_ACTIONS, NAV_SAVE, NAVBAR}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}}
+#define NAV_ROW_EXIT                                                               \
+  {{{{NAV_IF_SAVE_ACTIONS, NAV_NO_ACTION, SAVE}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}, \
+   {{{NAV_IF_SAVE_ACTIONS, NAV_NO_ACTION, SAVE}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}, \
+   {{{NAV_IF_SAVE_ACTIONS, NAV_EXIT, NAVBAR}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}}
+
+// [page kind][context][input]: rows in CONTEXT order (NONE, NAVBAR, PAGE, ITEM, SAVE, EXIT), inputs CW, CCW, PUSH.
+static constexpr NavRule s_navigationTable[PAGE_NAVIGATION_COUNT][NAV_CONTEXT_COUNT][NAV_INPUT_COUNT] = {
+    // PAGE_NAVIGATION_LIST: turning moves the selection and overflows into the save actions. Past the last
+    // item without save actions, the navbar takes over.
+    {NAV_ROW_NONE,
+     NAV_ROW_NAVBAR,
+     {{{{NAV_IF_SELECTED, NAV_NO_ACTION, PAGE}, {NAV_IF_SAVE_ACTIONS, NAV_NO_ACTION, SAVE}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}},
+      {{{NAV_IF_SELECTED, NAV_NO_ACTION, PAGE}, {NAV_IF_SAVE_ACTIONS, NAV_NO_ACTION, SAVE}, {NAV_ALWAYS, NAV_NO_ACTION, PAGE}}},
+      {{{NAV_IF_ITEMS, NAV_NO_ACTION, ITEM}, {NAV_ALWAYS, NAV_NO_ACTION, PAGE}}}},
+     {{{{NAV_ALWAYS, NAV_ITEM_INPUT, ITEM}}},
+      {{{NAV_ALWAYS, NAV_ITEM_INPUT, ITEM}}},
+      NAV_GO(PAGE)},
+     NAV_ROW_SAVE,
+     NAV_ROW_EXIT},
+    // PAGE_NAVIGATION_HERO: the first turn already edits the item. A push ends the edit; without an item
+    // there is nothing to save.
+    {NAV_ROW_NONE,
+     NAV_ROW_NAVBAR,
+     {{{{NAV_IF_ITEMS, NAV_ITEM_INPUT, ITEM}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}},
+      {{{NAV_IF_ITEMS, NAV_ITEM_INPUT, ITEM}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}},
+      {{{NAV_IF_ITEM_SAVE, NAV_NO_ACTION, SAVE}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}},
+     {{{{NAV_IF_ITEMS, NAV_ITEM_INPUT, ITEM}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}},
+      {{{NAV_IF_ITEMS, NAV_ITEM_INPUT, ITEM}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}},
+      {{{NAV_IF_ITEM_SAVE, NAV_NO_ACTION, SAVE}, {NAV_ALWAYS, NAV_NO_ACTION, NAVBAR}}}},
+     NAV_ROW_SAVE,
+     NAV_ROW_EXIT},
+    // PAGE_NAVIGATION_SCROLL: turning scrolls, a push returns to the navbar.
+    {NAV_ROW_NONE,
+     NAV_ROW_NAVBAR,
+     {{{{NAV_IF_SELECTED, NAV_NO_ACTION, PAGE}, {NAV_ALWAYS, NAV_NO_ACTION, PAGE}}},
+      {{{NAV_IF_SELECTED, NAV_NO_ACTION, PAGE}, {NAV_ALWAYS, NAV_NO_ACTION, PAGE}}},
+      NAV_GO(NAVBAR)},
+     {NAV_GO(PAGE), NAV_GO(PAGE), NAV_GO(PAGE)},
+     NAV_ROW_SAVE,
+     NAV_ROW_EXIT},
+    // PAGE_NAVIGATION_CUSTOM: the page decides, NONE hands over to the navbar.
+    {NAV_ROW_NONE,
+     NAV_ROW_NAVBAR,
+     {{{{NAV_ALWAYS, NAV_CUSTOM, NONE}}}, {{{NAV_ALWAYS, NAV_CUSTOM, NONE}}}, {{{NAV_ALWAYS, NAV_CUSTOM, NONE}}}},
+     {{{{NAV_ALWAYS, NAV_CUSTOM, NONE}}}, {{{NAV_ALWAYS, NAV_CUSTOM, NONE}}}, {{{NAV_ALWAYS, NAV_CUSTOM, NONE}}}},
+     NAV_ROW_SAVE,
+     NAV_ROW_EXIT},
+};
+
+// Compile-time checks over the flattened table: every entry ends with an unconditional outcome, and every
+// guard, action and target is in range.
+#define NAV_RULE_COUNT (PAGE_NAVIGATION_COUNT * NAV_CONTEXT_COUNT * NAV_INPUT_COUNT)
+
+static constexpr const NavRule &navRuleAt(int index)
+{
+  return s_navigationTable[index / (NAV_CONTEXT_COUNT * NAV_INPUT_COUNT)][index / NAV_INPUT_COUNT % NAV_CONTEXT_COUNT][index % NAV_INPUT_COUNT];
+}
+
+static constexpr bool navOutcomeValid(const NavOutcome &outcome)
+{
+  return outcome.guard < NAV_GUARD_COUNT && outcome.action < NAV_ACTION_COUNT && outcome.to < NAV_CONTEXT_COUNT;
+}
+
+static constexpr bool navRuleTerminates(const NavRule &rule, int outcome)
+{
+  return outcome < NAV_MAX_OUTCOMES && navOutcomeValid(rule.outcomes[outcome]) &&
+         (rule.outcomes[outcome].guard == NAV_ALWAYS || navRuleTerminates(rule, outcome + 1));
+}
+
+static constexpr bool navTableValid(int index)
+{
+  return index >= NAV_RULE_COUNT || (navRuleTerminates(navRuleAt(index), 0) && navTableValid(index + 1));
+}
+
+static_assert(navTableValid(0), "every navigation entry must end with a NAV_ALWAYS outcome");
+
+const NavRule &navigationRule(u_int8_t navigation, u_int8_t context, u_int8_t input)
+{
+  if (navigation >= PAGE_NAVIGATION_COUNT || context >= NAV_CONTEXT_COUNT || input >= NAV_INPUT_COUNT)
+  {
+    return s_navigationTable[PAGE_NAVIGATION_LIST][NONE][0];
+  }
+  return s_navigationTable[navigation][context][input];
+}
+
+const NavOutcome &navigationResolve(u_int8_t navigation, u_int8_t context, u_int8_t input, u_int8_t guardMask)
+{
+  const NavOutcome *outcome = navigationRule(navigation, context, input).outcomes;
+  while (outcome->guard != NAV_ALWAYS && !(guardMask & (1 << outcome->guard)))
+  {
+    outcome++;
+  }
+  return *outcome;
+}
+
+bool Container::navigationGuard(u_int8_t guard, ROTARY_EVENT input)
+{
+  switch (guard)
+  {
+  case NAV_IF_SAVE_ACTIONS:
+    return m_currentPage->m_enableSaveActions;
+  case NAV_IF_ITEMS:
+    return m_currentPage->hasItems();
+  case NAV_IF_SELECTED:
+    return m_currentPage->moveSelection(input == ROTARY_EVENT_CW ? 1 : -1);
+  case NAV_IF_ITEM_SAVE:
+    return m_currentPage->hasItems() && m_currentPage->m_enableSaveActions;
+  default:
+    return true;
+  }
+}
+
+void Container::navigate(ROTARY_EVENT input)
+{
+  if (m_currentPage == nullptr || input >= NAV_INPUT_COUNT)
+  {
+    return;
+  }
+  Page *page = m_currentPage;
+  u_int8_t from = m_context == NAVBAR ? NAVBAR : page->m_context;
+  const NavOutcome *outcome = navigationRule(page->navigation(), from, input).outcomes;
+  while (!navigationGuard(outcome->guard, input))
+  {
+    outcome++; // bounded: the last outcome is NAV_ALWAYS
+  }
+
+  u_int8_t to = outcome->to;
+  Event event = {EVENT_ROT, (unsigned long)input};
+  switch (outcome->action)
+  {
+  case NAV_PAGE_NEXT:
+  case NAV_PAGE_PREVIOUS:
+    trackCurrentPage(input);
+    break;
+  case NAV_ITEM_INPUT:
+    page->itemInput(event, false);
+    break;
+  case NAV_SAVE:
+    page->commitEdits();
+    break;
+  case NAV_EXIT:
+    page->discardEdits();
+    break;
+  case NAV_CUSTOM:
+    if (from == ITEM)
+    {
+      page->itemInput(event, true);
+    }
+    else
+    {
+      page->onPageEvent(event);
+    }
+    to = page->m_context == NONE ? NAVBAR : page->m_context;
+    break;
+  default:
+    break;
+  }
+  DEBUG_SIMPLEUI("Container::navigate: %d -%d-> %d\n", from, input, to);
+  SIMPLEUI_TRACE(TRACE_NAVIGATION, from, input, to);
+
+  if (to == NAVBAR)
+  {
+    if (from != NAVBAR)
+    {
+      page->reset();
+      page->m_context = NONE;
+    }
+    m_context = NAVBAR;
+    m_navbar.m_context = NAVBAR;
+  }
+  else
+  {
+    m_context = PAGE;
+    m_navbar.m_context = NONE;
+    page->m_context = (CONTEXT)to;
+  }
+}
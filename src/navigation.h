@@ -0,0 +1,69 @@
+#ifndef Futojin_NAVIGATION_H
+#define Futojin_NAVIGATION_H
+
+#include "internal.h"
+#include <sys/types.h>
+
+// Encoder navigation as one transition table (navigation.cpp). The UI is always in one CONTEXT: NAVBAR while
+// a page is being chosen, or PAGE, ITEM, SAVE or EXIT inside the current page. NONE (page entered, nothing
+// selected) is only reached through a restored snapshot.
+//
+// The table is indexed by the kind of the current page, the context and the input. Each entry lists up to
+// NAV_MAX_OUTCOMES outcomes, tried in order: the first one whose guard holds runs its action, then the UI
+// moves to its target context. The last outcome of every entry is unconditional, which the table checks at
+// compile time. An event therefore costs one lookup, at most NAV_MAX_OUTCOMES guards and one action.
+
+enum PAGE_NAVIGATION
+{
+  PAGE_NAVIGATION_LIST,   // a movable selection over items, edited one at a time (list pages)
+  PAGE_NAVIGATION_HERO,   // a single item, edited as soon as the encoder turns (hero pages)
+  PAGE_NAVIGATION_SCROLL, // read-only content that scrolls, a push leaves (diagnostics)
+  PAGE_NAVIGATION_CUSTOM, // the page handles onPageEvent() and onItemEvent() and sets its own context
+  PAGE_NAVIGATION_COUNT
+};
+
+enum NAV_GUARD
+{
+  NAV_ALWAYS,
+  NAV_IF_SAVE_ACTIONS, // the page has save actions enabled
+  NAV_IF_ITEMS,        // the page has something to edit
+  NAV_IF_SELECTED,     // the page moved its selection one step in the direction of the input
+  NAV_IF_ITEM_SAVE,    // the page has something to edit and save actions enabled
+  NAV_GUARD_COUNT
+};
+
+enum NAV_ACTION
+{
+  NAV_NO_ACTION,
+  NAV_PAGE_NEXT,     // the navbar moves to the next enabled page
+  NAV_PAGE_PREVIOUS, // the navbar moves to the previous enabled page
+  NAV_ITEM_INPUT,    // the input goes to the item being edited
+  NAV_SAVE,          // save actions: commit settings, onSave()
+  NAV_EXIT,          // save actions: revert settings, onExit(), re-read the values
+  NAV_CUSTOM,        // onPageEvent() or onItemEvent(); the target is the context the page sets
+  NAV_ACTION_COUNT
+};
+
+#define NAV_CONTEXT_COUNT (EXIT + 1)
+#define NAV_INPUT_COUNT 3 // ROTARY_EVENT_CW, ROTARY_EVENT_CCW, ROTARY_EVENT_PUSH
+#define NAV_MAX_OUTCOMES 3
+
+struct NavOutcome
+{
+  u_int8_t guard;  // NAV_GUARD
+  u_int8_t action; // NAV_ACTION
+  u_int8_t to;     // CONTEXT
+};
+
+struct NavRule
+{
+  NavOutcome outcomes[NAV_MAX_OUTCOMES]; // tried in order up to the first NAV_ALWAYS
+};
+
+// Entry for a page kind, context and input. Out of range arguments return the entry of NONE.
+const NavRule &navigationRule(u_int8_t navigation, u_int8_t context, u_int8_t input);
+// Outcome taken when the guards set in guardMask (1 << NAV_GUARD) hold, without running anything. The native
+// build checks every kind, context, input and guard combination through it (bench/bench.cpp).
+const NavOutcome &navigationResolve(u_int8_t navigation, u_int8_t context, u_int8_t input, u_int8_t guardMask);
+
+#endif // Futojin_NAVIGATION_H
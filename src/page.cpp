@@ -1,123 +1,195 @@
 #include "simpleUI.h"
-Event PAGE_YIELD = {EVENT_YIELD, PAGE};
 
 Page::Page(const unsigned char *icon)
     : m_icon(icon),
       m_display(nullptr),
+      m_container(nullptr),
       m_context(NONE),
       m_enabled(true),
-      m_enableSaveActions(false)
+      m_enableSaveActions(false),
+      m_settings(nullptr),
+      m_active(false),
+      m_position(0),
+      m_editCount(0),
+      m_editsTracked(true),
+      onSave(nullptr),
+      onExit(nullptr)
 {
 }
 
+void Page::enable(bool enabled)
+{
+  m_enabled = enabled;
+  if (m_container)
+  {
+    m_container->onPageEnabledChanged(m_position, enabled);
+  }
+}
+
+void Page::activate()
+{
+  if (!m_active)
+  {
+    DEBUG_SIMPLEUI("Page::activate\n");
+    m_active = true;
+    start();
+  }
+}
+
 void Page::draw()
 {
   DEBUG_SIMPLEUI("Page::draw\n");
+  activate(); // normally already done when the page became current
   drawItems();
   drawSaveActions();
 }
 
-void Page::checkAndYield()
+// Item updates are only drawn while the page is on screen; the next full frame shows them otherwise.
+void Page::requestUpdate()
 {
-  if (m_context == NONE)
+  if (m_container && m_container->m_currentPage == this)
   {
-    DEBUG_SIMPLEUI("Page::checkAndYield: YIELD()\n");
-    reset();
-    m_container->onEventYield(PAGE_YIELD);
+    m_container->requestDraw(Container::RENDER_UPDATE);
   }
 }
 
-void Page::onEvent(Event &event)
+void Page::onBusEvent(const Event &event)
 {
-  DEBUG_SIMPLEUI("Page::onEvent:Event: %d %lu\n", event.eventId, event.value);
-  DEBUG_SIMPLEUI("Page::onEvent:Context: %d\n", m_context);
-  if (m_context == PAGE && event.eventId == EVENT_ROT)
+  DEBUG_SIMPLEUI("Page::onBusEvent:Event: %d %lu\n", event.eventId, event.value);
+  invalidate();
+  if (m_container && m_container->m_currentPage == this)
   {
-    onPageEvent(event);
-    DEBUG_SIMPLEUI("Page::onEvent:New-Context: %d\n", m_context);
-    checkAndYield();
+    m_container->requestDraw(); // draw() starts the page again
   }
-  else if (m_context == ITEM && event.eventId == EVENT_ROT)
+}
+
+// Encoder input for the item being edited (NAV_ITEM_INPUT, or NAV_CUSTOM from ITEM).
+void Page::itemInput(Event &event, bool custom)
+{
+  u_int32_t editCount = m_editCount;
+  if (custom)
   {
     onItemEvent(event);
-    DEBUG_SIMPLEUI("Page::onEvent:New-Context: %d\n", m_context);
-    checkAndYield();
-  }
-  else if (m_context == SAVE && event.eventId == EVENT_ROT)
-  {
-    onSaveEvent(event);
-    DEBUG_SIMPLEUI("Page::onEvent:New-Context: %d\n", m_context);
-    checkAndYield();
   }
-  else if (m_context == EXIT && event.eventId == EVENT_ROT)
+  else
   {
-    onExitEvent(event);
-    DEBUG_SIMPLEUI("Page::onEvent:New-Context: %d\n", m_context);
-    checkAndYield();
+    onItemInput(event);
   }
-  else if (m_context == NONE && event.eventId == EVENT_ROT && event.value == ROTARY_EVENT_PUSH)
+  if (m_enableSaveActions && m_editCount == editCount)
   {
-    DEBUG_SIMPLEUI("Page::onPush: NONE -> PAGE\n");
-    m_context = PAGE;
+    m_editsTracked = false; // the page changed something item_edit() did not see
   }
+  touchSettings();
 }
 
-void Page::onSaveEvent(Event &event)
+// Edit transactions: the first edit of an item since the last save or exit keeps its value. Only pages with
+// save actions record; a lookup costs one comparison per item edited so far.
+void Page::recordEdit(Item &item)
 {
-  // inconsistent state, yield to container.
+  m_editCount++;
   if (!m_enableSaveActions)
   {
-    DEBUG_SIMPLEUI("Page::onEvent: SAVE inconsistent YIELD()\n");
-    m_context = NONE;
     return;
   }
-
-  if (event.value == ROTARY_EVENT_CW)
-  {
-    DEBUG_SIMPLEUI("Page::onEvent: SAVE -> EXIT\n");
-    m_context = EXIT;
-  }
-  else if (event.value == ROTARY_EVENT_CCW)
+  for (const EditRecord &record : m_edits)
   {
-    DEBUG_SIMPLEUI("Page::onEvent: SAVE -> PAGE\n");
-    m_context = PAGE;
+    if (record.item == &item)
+    {
+      return;
+    }
   }
-  else if (event.value == ROTARY_EVENT_PUSH)
+  EditRecord record;
+  record.item = &item;
+  const char *value = item.value ? item.value : "";
+  record.truncated = strlen(value) >= sizeof(record.value);
+  strncpy(record.value, value, sizeof(record.value) - 1);
+  record.value[sizeof(record.value) - 1] = '\0';
+  m_edits.push_back(record);
+}
+
+// Drops the items edited back to their value, keeping the order of the others.
+void Page::pruneEdits()
+{
+  size_t kept = 0;
+  for (const EditRecord &record : m_edits)
   {
-    if (m_enableSaveActions && onSave)
+    const char *value = record.item->value ? record.item->value : "";
+    if (record.truncated || strcmp(value, record.value) != 0)
     {
-      DEBUG_SIMPLEUI("Page::onSaveEvent: onSave callback\n");
-      onSave();
+      m_edits[kept++] = record;
     }
-    DEBUG_SIMPLEUI("Page::onPush YIELD(SAVE)\n");
-    m_context = NONE;
   }
+  m_edits.resize(kept);
 }
 
-void Page::onExitEvent(Event &event)
+void Page::clearEdits()
 {
-  if (!m_enableSaveActions)
+  m_edits.clear();
+  m_editsTracked = true;
+}
+
+// Save actions, chosen through the navigation table. Both cost one step per edited item; pages whose input
+// bypassed item_edit() fall back to the whole page.
+void Page::commitEdits()
+{
+  pruneEdits();
+  // Always committed: bound values can change without their text changing, or without an item edit at all,
+  // and a commit with nothing to write costs a memcmp per setting.
+  if (m_settings)
   {
-    DEBUG_SIMPLEUI("Page::onEvent: SAVE inconsistent YIELD()\n");
-    m_context = NONE;
-    return;
+    DEBUG_SIMPLEUI("Page::commitEdits: commit settings\n");
+    m_settings->commit();
+  }
+  if (onSave)
+  {
+    DEBUG_SIMPLEUI("Page::commitEdits: onSave callback, %u items changed\n", (unsigned)m_edits.size());
+    onSave();
   }
+  clearEdits();
+}
 
-  if (event.value == ROTARY_EVENT_CCW || event.value == ROTARY_EVENT_CW)
+void Page::discardEdits()
+{
+  if (m_settings)
+  {
+    DEBUG_SIMPLEUI("Page::discardEdits: revert settings\n");
+    m_settings->revert(this);
+  }
+  if (onExit)
+  {
+    DEBUG_SIMPLEUI("Page::discardEdits: onExit callback\n");
+    onExit();
+  }
+  if (!m_settings && !onExit)
   {
-    DEBUG_SIMPLEUI("Page::onEvent: EXIT -> SAVE\n");
-    m_context = SAVE;
+    clearEdits(); // nothing was reverted
+    return;
   }
-  else if (event.value == ROTARY_EVENT_PUSH)
+  if (m_editsTracked)
   {
-    if (m_enableSaveActions && onExit)
+    // Item values point into application buffers, so every edited item re-reads its reverted value. Not only
+    // the changed ones: an item edited back to its text may still hold a different value behind it.
+    for (const EditRecord &record : m_edits)
     {
-      DEBUG_SIMPLEUI("Page::onExitEvent: onExit callback\n");
-      onExit();
-      start(); // re-get values
+      DEBUG_SIMPLEUI("Page::discardEdits: restore %s\n", record.item->m_label);
+      Event initEvent = {EVENT_EMPTY, 0};
+      item_onEvent(*record.item, initEvent);
     }
-    DEBUG_SIMPLEUI("Page::onPush YIELD(EXIT)\n");
-    m_context = NONE;
+  }
+  else
+  {
+    invalidate(); // re-get values
+    activate();
+  }
+  clearEdits();
+}
+
+// After an item edit. Pages with save actions commit on save instead.
+void Page::touchSettings()
+{
+  if (m_settings && !m_enableSaveActions)
+  {
+    m_settings->touch();
   }
 }
 
@@ -133,29 +205,53 @@ void Page::drawSaveActions()
     int16_t y = height - ICON_SIZE - 1; //-1 for border
     int16_t x_exit = width - ICON_SIZE - 1;
     int16_t x_save = x_exit - ICON_SIZE;
-    if (m_context == SAVE) // Save icon selected
+    TransitionRect highlight;
+    if (saveActionHighlight(highlight))
     {
-      m_display->drawRect(x_save, y, ICON_SIZE, ICON_SIZE);
-    }
-    else if (m_context == EXIT) // Exit icon selected
-    {
-      m_display->drawRect(x_exit, y, ICON_SIZE, ICON_SIZE);
+      m_display->drawRect(highlight.x, highlight.y, highlight.w, highlight.h);
     }
 
     m_display->drawXbm(x_exit, y, ICON_SIZE, ICON_SIZE, icon_back);
     m_display->drawXbm(x_save, y, ICON_SIZE, ICON_SIZE, icon_save);
   }
 }
+
+bool Page::saveActionHighlight(TransitionRect &rect) const
+{
+  if (!m_enableSaveActions || (m_context != SAVE && m_context != EXIT))
+  {
+    return false;
+  }
+  int16_t x_exit = m_display->getWidth() - ICON_SIZE - 1;
+  rect.x = m_context == SAVE ? x_exit - ICON_SIZE : x_exit;
+  rect.y = m_display->getHeight() - ICON_SIZE - 1; //-1 for border
+  rect.w = ICON_SIZE;
+  rect.h = ICON_SIZE;
+  return true;
+}
+
 void Page::enableSaveActions(void (*onSave)(), void (*onExit)())
 {
   m_enableSaveActions = true;
+  clearEdits();
   this->onSave = onSave;
   this->onExit = onExit;
 }
 
+void Page::enableSaveActions(SettingsStore &settings, void (*onExit)())
+{
+  m_enableSaveActions = true;
+  clearEdits();
+  m_settings = &settings;
+  this->onSave = nullptr;
+  this->onExit = onExit;
+}
+
 void Page::disableSaveActions()
 {
   m_enableSaveActions = false;
+  clearEdits();
+  m_settings = nullptr;
   this->onSave = nullptr;
   this->onExit = nullptr;
 }
\ No newline at end of file
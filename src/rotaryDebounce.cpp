@@ -4,6 +4,8 @@
 
 #define MAX_ROTARY_STATE_TRANSITION_MS 500
 #define QUEUE_LENGTH 10
+#define ISR_TASK_STACK_SIZE 2048
+#define CALLBACK_TASK_STACK_SIZE 4096
 
 static QueueHandle_t rotaryDebounceIsrQueue = nullptr;
 static QueueHandle_t callbackQueue = nullptr;
@@ -11,6 +13,12 @@ static QueueHandle_t callbackQueue = nullptr;
 static TaskHandle_t rotaryDebounceIsrHandler = nullptr;
 static TaskHandle_t rotaryDebounceCallbackHandler = nullptr;
 
+// Queue usage, for Container::getResourceStats()
+static volatile u_int16_t isrQueuePeak = 0;
+static volatile u_int32_t isrQueueDropped = 0;
+static volatile u_int16_t callbackQueuePeak = 0;
+static volatile u_int32_t callbackQueueDropped = 0;
+
 void IRAM_ATTR rotary_isr(void *arg)
 {
   if (arg == nullptr)
@@ -18,13 +26,25 @@ void IRAM_ATTR rotary_isr(void *arg)
     return;
   }
   RotaryDebounce *debounceInstance = (RotaryDebounce *)arg;
+  SIMPLEUI_TRACE(TRACE_ROTARY_ISR);
 
   RotaryDebounce::IsrTaskParams params;
   params.interruptMs = millis();
   params.debounceInstance = debounceInstance;
 
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-  xQueueSendFromISR(rotaryDebounceIsrQueue, &params, &xHigherPriorityTaskWoken);
+  if (xQueueSendFromISR(rotaryDebounceIsrQueue, &params, &xHigherPriorityTaskWoken) == pdTRUE)
+  {
+    UBaseType_t depth = uxQueueMessagesWaitingFromISR(rotaryDebounceIsrQueue);
+    if (depth > isrQueuePeak)
+    {
+      isrQueuePeak = depth;
+    }
+  }
+  else
+  {
+    isrQueueDropped++;
+  }
   if (xHigherPriorityTaskWoken)
   {
     portYIELD_FROM_ISR();
@@ -50,9 +70,16 @@ void handleRotaryCallbackTask(void *parameter)
     RotaryDebounce::CallbackTaskParams params;
     if (xQueueReceive(callbackQueue, &params, portMAX_DELAY))
     {
-      DEBUG_SIMPLEUI("RotaryDebounce Event: %d\n", params.event);
-      DEBUG_SIMPLEUI("--------------------------------------------\n");
-      params.debounceInstance->onRotaryEvent(params.event);
+      SIMPLEUI_TRACE(TRACE_ROTARY_EVENT, params.event);
+      RotaryDebounce *debounceInstance = params.debounceInstance;
+      if (debounceInstance->onRotaryEventArg)
+      {
+        debounceInstance->onRotaryEventArg(params.event, debounceInstance->m_callbackArg);
+      }
+      else if (debounceInstance->onRotaryEvent)
+      {
+        debounceInstance->onRotaryEvent(params.event);
+      }
     }
   }
 }
@@ -60,8 +87,12 @@ void handleRotaryCallbackTask(void *parameter)
 RotaryDebounce::RotaryDebounce(const u_int8_t pinA, const u_int8_t pinB, void (*rotaryEventResponder)(const ROTARY_EVENT event))
     : m_pinA(pinA),
       m_pinB(pinB),
-      onRotaryEvent(rotaryEventResponder)
+      onRotaryEvent(rotaryEventResponder),
+      onRotaryEventArg(nullptr),
+      m_callbackArg(nullptr)
 {
+  resetState();
+
   if (rotaryDebounceIsrQueue == nullptr)
   {
     rotaryDebounceIsrQueue = xQueueCreate(QUEUE_LENGTH, sizeof(IsrTaskParams));
@@ -74,6 +105,13 @@ RotaryDebounce::RotaryDebounce(const u_int8_t pinA, const u_int8_t pinB, void (*
   configureTask();
 }
 
+RotaryDebounce::RotaryDebounce(const u_int8_t pinA, const u_int8_t pinB, void (*rotaryEventResponder)(const ROTARY_EVENT event, void *arg), void *arg)
+    : RotaryDebounce(pinA, pinB, (void (*)(const ROTARY_EVENT))nullptr)
+{
+  onRotaryEventArg = rotaryEventResponder;
+  m_callbackArg = arg;
+}
+
 RotaryDebounce::~RotaryDebounce()
 {
   detachInterrupt(digitalPinToInterrupt(m_pinA));
@@ -82,7 +120,7 @@ RotaryDebounce::~RotaryDebounce()
 
 void RotaryDebounce::start()
 {
-  DEBUG_SIMPLEUI("Starting RotaryDebounce on pins A(%d), B(%d)\n", m_pinA, m_pinB);
+  SIMPLEUI_TRACE(TRACE_ROTARY_START, m_pinA, m_pinB);
   attachInterruptArg(digitalPinToInterrupt(m_pinA), rotary_isr, (void *)this, CHANGE);
   attachInterruptArg(digitalPinToInterrupt(m_pinB), rotary_isr, (void *)this, CHANGE);
 }
@@ -94,7 +132,7 @@ void RotaryDebounce::configureTask()
     xTaskCreate(
         handleRotaryDebounceQueueTask, // Function that implements the task.
         "Debounce Queue Task",         // Text name for the task.
-        2048,                          // Stack size in bytes.
+        ISR_TASK_STACK_SIZE,           // Stack size in bytes.
         nullptr,                       // Task input parameter.
         3 | portPRIVILEGE_BIT,         // Priority at which the task is created. (0=lowest)
         &rotaryDebounceIsrHandler);    // Used to pass out the created task's handle.
@@ -105,7 +143,7 @@ void RotaryDebounce::configureTask()
     xTaskCreate(
         handleRotaryCallbackTask,
         "Rotary Callback Task",
-        4096,
+        CALLBACK_TASK_STACK_SIZE,
         nullptr,
         2 | portPRIVILEGE_BIT,
         &rotaryDebounceCallbackHandler);
@@ -118,12 +156,11 @@ void RotaryDebounce::abInterrupt(unsigned long currentMs)
   int pinBState = digitalRead(m_pinB);
   if (m_rotaryState.phase != RESET && currentMs - m_rotaryState.startMs > MAX_ROTARY_STATE_TRANSITION_MS)
   {
-    DEBUG_SIMPLEUI("Timeout exceeded. (%lu ms)\n", currentMs - m_rotaryState.startMs);
+    SIMPLEUI_TRACE(TRACE_ROTARY_TIMEOUT, currentMs - m_rotaryState.startMs);
     resetState();
   }
 
-  DEBUG_SIMPLEUI("abInterrupt: A=%d, B=%d\n", pinAState, pinBState);
-  DEBUG_SIMPLEUI("Current Phase: %d\n", m_rotaryState.phase);
+  SIMPLEUI_TRACE(TRACE_ROTARY_EDGE, pinAState, pinBState, m_rotaryState.phase);
 
   switch (m_rotaryState.phase)
   {
@@ -168,7 +205,7 @@ void RotaryDebounce::abInterrupt(unsigned long currentMs)
     break;
   }
 
-  DEBUG_SIMPLEUI("New Phase: %d, direction: %d\n", m_rotaryState.phase, m_rotaryState.direction);
+  SIMPLEUI_TRACE(TRACE_ROTARY_PHASE, m_rotaryState.phase, m_rotaryState.direction);
   if (m_rotaryState.phase == S4)
   {
     ROTARY_EVENT event = m_rotaryState.direction;
@@ -177,7 +214,64 @@ void RotaryDebounce::abInterrupt(unsigned long currentMs)
     RotaryDebounce::CallbackTaskParams params;
     params.debounceInstance = this;
     params.event = event;
-    xQueueSend(callbackQueue, &params, 0);
+    if (xQueueSend(callbackQueue, &params, 0) == pdTRUE)
+    {
+      UBaseType_t depth = uxQueueMessagesWaiting(callbackQueue);
+      if (depth > callbackQueuePeak)
+      {
+        callbackQueuePeak = depth;
+      }
+    }
+    else
+    {
+      callbackQueueDropped++;
+    }
+  }
+}
+
+void RotaryDebounce::getResourceStats(ResourceStats &stats)
+{
+  TaskStats &isrTask = stats.tasks[RESOURCE_TASK_ROTARY_ISR];
+  isrTask.name = "Rotary ISR";
+  isrTask.stackSize = ISR_TASK_STACK_SIZE;
+  isrTask.created = rotaryDebounceIsrHandler != nullptr;
+  isrTask.stackHighWaterMark = isrTask.created ? uxTaskGetStackHighWaterMark(rotaryDebounceIsrHandler) : 0;
+
+  TaskStats &callbackTask = stats.tasks[RESOURCE_TASK_ROTARY_CALLBACK];
+  callbackTask.name = "Rotary CB";
+  callbackTask.stackSize = CALLBACK_TASK_STACK_SIZE;
+  callbackTask.created = rotaryDebounceCallbackHandler != nullptr;
+  callbackTask.stackHighWaterMark = callbackTask.created ? uxTaskGetStackHighWaterMark(rotaryDebounceCallbackHandler) : 0;
+
+  QueueStats &isrQueue = stats.queues[RESOURCE_QUEUE_ROTARY_ISR];
+  isrQueue.name = "Rotary ISR Q";
+  isrQueue.length = QUEUE_LENGTH;
+  isrQueue.depth = rotaryDebounceIsrQueue ? uxQueueMessagesWaiting(rotaryDebounceIsrQueue) : 0;
+  isrQueue.peak = isrQueuePeak;
+  isrQueue.dropped = isrQueueDropped;
+
+  QueueStats &callbackQueueStats = stats.queues[RESOURCE_QUEUE_ROTARY_CALLBACK];
+  callbackQueueStats.name = "Rotary CB Q";
+  callbackQueueStats.length = QUEUE_LENGTH;
+  callbackQueueStats.depth = callbackQueue ? uxQueueMessagesWaiting(callbackQueue) : 0;
+  callbackQueueStats.peak = callbackQueuePeak;
+  callbackQueueStats.dropped = callbackQueueDropped;
+
+  if (isrTask.created)
+  {
+    stats.sharedHeapBytes += ISR_TASK_STACK_SIZE + sizeof(StaticTask_t);
+  }
+  if (callbackTask.created)
+  {
+    stats.sharedHeapBytes += CALLBACK_TASK_STACK_SIZE + sizeof(StaticTask_t);
+  }
+  if (rotaryDebounceIsrQueue)
+  {
+    stats.sharedHeapBytes += QUEUE_LENGTH * sizeof(IsrTaskParams) + sizeof(StaticQueue_t);
+  }
+  if (callbackQueue)
+  {
+    stats.sharedHeapBytes += QUEUE_LENGTH * sizeof(CallbackTaskParams) + sizeof(StaticQueue_t);
   }
 }
 
@@ -0,0 +1,411 @@
+#include "settingsStore.h"
+#include <stdio.h>
+#include <string.h>
+
+#define COMMIT_TASK_STACK_SIZE 3072
+
+#ifdef ESP_PLATFORM
+NvsSettingsBackend::NvsSettingsBackend(const char *nvsNamespace)
+    : m_namespace(nvsNamespace),
+      m_handle(0),
+      m_open(false)
+{
+}
+
+NvsSettingsBackend::~NvsSettingsBackend()
+{
+  if (m_open)
+  {
+    nvs_close(m_handle);
+  }
+}
+
+bool NvsSettingsBackend::open()
+{
+  if (!m_open)
+  {
+    m_open = nvs_open(m_namespace, NVS_READWRITE, &m_handle) == ESP_OK;
+  }
+  return m_open;
+}
+
+bool NvsSettingsBackend::read(const char *key, void *data, size_t size)
+{
+  size_t length = 0;
+  if (!open() || nvs_get_blob(m_handle, key, nullptr, &length) != ESP_OK || length != size)
+  {
+    return false;
+  }
+  return nvs_get_blob(m_handle, key, data, &length) == ESP_OK;
+}
+
+bool NvsSettingsBackend::write(const char *key, const void *data, size_t size)
+{
+  return open() && nvs_set_blob(m_handle, key, data, size) == ESP_OK;
+}
+
+bool NvsSettingsBackend::commit()
+{
+  return open() && nvs_commit(m_handle) == ESP_OK;
+}
+#endif
+
+FileSettingsBackend::FileSettingsBackend(const char *path)
+    : m_path(path),
+      m_loaded(false),
+      m_staged(false)
+{
+}
+
+// Records are: key length (1 byte), key, value size (2 bytes, little endian), value.
+void FileSettingsBackend::load()
+{
+  m_loaded = true;
+  FILE *file = fopen(m_path, "rb");
+  if (file == nullptr)
+  {
+    return; // nothing saved yet
+  }
+  Record record;
+  int keyLength;
+  while ((keyLength = fgetc(file)) != EOF)
+  {
+    uint8_t size[2];
+    if (keyLength >= SETTINGS_KEY_SIZE || fread(record.key, 1, keyLength, file) != (size_t)keyLength ||
+        fread(size, 1, 2, file) != 2)
+    {
+      break; // truncated file: keep what was complete
+    }
+    record.key[keyLength] = '\0';
+    record.data.resize(size[0] | size[1] << 8);
+    if (fread(record.data.data(), 1, record.data.size(), file) != record.data.size())
+    {
+      break;
+    }
+    m_records.push_back(record);
+  }
+  fclose(file);
+}
+
+FileSettingsBackend::Record *FileSettingsBackend::find(const char *key)
+{
+  if (!m_loaded)
+  {
+    load();
+  }
+  for (Record &record : m_records)
+  {
+    if (strcmp(record.key, key) == 0)
+    {
+      return &record;
+    }
+  }
+  return nullptr;
+}
+
+bool FileSettingsBackend::read(const char *key, void *data, size_t size)
+{
+  Record *record = find(key);
+  if (record == nullptr || record->data.size() != size)
+  {
+    return false;
+  }
+  memcpy(data, record->data.data(), size);
+  return true;
+}
+
+bool FileSettingsBackend::write(const char *key, const void *data, size_t size)
+{
+  if (strlen(key) >= SETTINGS_KEY_SIZE || size > UINT16_MAX)
+  {
+    return false;
+  }
+  Record *record = find(key);
+  if (record == nullptr)
+  {
+    m_records.push_back(Record());
+    record = &m_records.back();
+    strcpy(record->key, key);
+  }
+  record->data.assign((const uint8_t *)data, (const uint8_t *)data + size);
+  m_staged = true;
+  return true;
+}
+
+bool FileSettingsBackend::commit()
+{
+  if (!m_staged)
+  {
+    return true;
+  }
+  char tmpPath[256];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", m_path);
+  FILE *file = fopen(tmpPath, "wb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  bool ok = true;
+  for (const Record &record : m_records)
+  {
+    uint8_t keyLength = strlen(record.key);
+    uint8_t size[2] = {(uint8_t)record.data.size(), (uint8_t)(record.data.size() >> 8)};
+    ok = ok && fputc(keyLength, file) != EOF && fwrite(record.key, 1, keyLength, file) == keyLength &&
+         fwrite(size, 1, 2, file) == 2 && fwrite(record.data.data(), 1, record.data.size(), file) == record.data.size();
+  }
+  ok = fclose(file) == 0 && ok;
+  // The old file stays complete until the new one has been written.
+  ok = ok && rename(tmpPath, m_path) == 0;
+  m_staged = !ok;
+  return ok;
+}
+
+// NVS writes and nvs_commit() take tens to hundreds of ms, which would hold up every other timer (switch
+// debounce, screen saver, overlay) if they ran in the timer service task. The timer only wakes the commit task.
+void settingsStore_timerCallback(TimerHandle_t timer)
+{
+  SettingsStore *store = (SettingsStore *)pvTimerGetTimerID(timer);
+  if (store->m_commitTaskHandle)
+  {
+    xTaskNotifyGive(store->m_commitTaskHandle);
+    return;
+  }
+  store->commit(); // SIMPLEUI_SYNC_RENDER
+}
+
+void settingsStore_commitTask(void *parameter)
+{
+  SettingsStore *store = (SettingsStore *)parameter;
+  for (;;)
+  {
+    if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0)
+    {
+      store->commit();
+    }
+  }
+}
+
+SettingsStore::SettingsStore(SettingsBackend &backend)
+    : m_backend(backend),
+      m_lock(xSemaphoreCreateMutex()),
+      m_commitTimer(nullptr),
+      m_commitTaskHandle(nullptr)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
+SettingsStore::~SettingsStore()
+{
+  if (m_commitTimer)
+  {
+    xTimerDelete(m_commitTimer, portMAX_DELAY);
+  }
+  // A commit holds the lock until the backend is done: the task is only deleted between commits.
+  lock();
+  if (m_commitTaskHandle)
+  {
+    vTaskDelete(m_commitTaskHandle);
+    m_commitTaskHandle = nullptr;
+  }
+  unlock();
+  for (Setting &setting : m_settings)
+  {
+    delete[] setting.committed;
+    delete[] setting.staged;
+  }
+  vSemaphoreDelete(m_lock);
+}
+
+void SettingsStore::lock()
+{
+  xSemaphoreTake(m_lock, portMAX_DELAY);
+}
+
+void SettingsStore::unlock()
+{
+  xSemaphoreGive(m_lock);
+}
+
+bool SettingsStore::bind(const char *key, void *data, size_t size, const void *owner)
+{
+  if (strlen(key) >= SETTINGS_KEY_SIZE || size == 0)
+  {
+    return false;
+  }
+  Setting setting;
+  strcpy(setting.key, key);
+  setting.data = data;
+  setting.committed = new uint8_t[size];
+  setting.staged = new uint8_t[size];
+  setting.size = size;
+  setting.written = false;
+  setting.owner = owner;
+  memcpy(setting.committed, data, size);
+  lock();
+  m_settings.push_back(setting);
+  m_stats.heapBytes += sizeof(Setting) + 2 * size;
+  unlock();
+  return true;
+}
+
+void SettingsStore::load()
+{
+  lock();
+  for (Setting &setting : m_settings)
+  {
+    if (m_backend.read(setting.key, setting.committed, setting.size))
+    {
+      memcpy(setting.data, setting.committed, setting.size);
+    }
+    else
+    {
+      memcpy(setting.committed, setting.data, setting.size); // default, written by the first commit that changes it
+    }
+  }
+  unlock();
+}
+
+bool SettingsStore::commit()
+{
+  lock();
+  if (m_commitTimer)
+  {
+    xTimerStop(m_commitTimer, 0); // an explicit commit covers the pending deferred one
+  }
+  unsigned long start = micros();
+  u_int32_t writes = 0;
+  bool ok = true;
+  for (Setting &setting : m_settings)
+  {
+    setting.written = false;
+    if (memcmp(setting.data, setting.committed, setting.size) == 0)
+    {
+      continue;
+    }
+    // Written from a copy, so the value recorded as committed below is exactly the stored one even if the
+    // application changes it meanwhile.
+    memcpy(setting.staged, setting.data, setting.size);
+    if (!m_backend.write(setting.key, setting.staged, setting.size))
+    {
+      m_stats.failures++;
+      ok = false;
+      continue;
+    }
+    setting.written = true;
+    writes++;
+  }
+
+  if (writes == 0)
+  {
+    if (ok)
+    {
+      m_stats.emptyCommits++;
+    }
+    unlock();
+    return ok;
+  }
+  if (m_backend.commit())
+  {
+    // Only now durable. Values whose write or commit failed stay dirty, so the next commit retries them.
+    for (Setting &setting : m_settings)
+    {
+      if (setting.written)
+      {
+        memcpy(setting.committed, setting.staged, setting.size);
+      }
+    }
+  }
+  else
+  {
+    m_stats.failures++;
+    ok = false;
+  }
+  u_int32_t elapsed = micros() - start;
+  m_stats.commits++;
+  m_stats.writes += writes;
+  m_stats.lastCommitUs = elapsed;
+  m_stats.maxCommitUs = elapsed > m_stats.maxCommitUs ? elapsed : m_stats.maxCommitUs;
+  unlock();
+  return ok;
+}
+
+void SettingsStore::revert()
+{
+  revert(nullptr);
+}
+
+void SettingsStore::revert(const void *owner)
+{
+  lock();
+  for (Setting &setting : m_settings)
+  {
+    if (owner == nullptr || setting.owner == nullptr || setting.owner == owner)
+    {
+      memcpy(setting.data, setting.committed, setting.size);
+    }
+  }
+  if (m_commitTimer && dirtyCount() == 0)
+  {
+    xTimerStop(m_commitTimer, 0); // edits of other owners keep their deferred commit
+  }
+  unlock();
+}
+
+size_t SettingsStore::dirtyCount() const
+{
+  size_t count = 0;
+  for (const Setting &setting : m_settings)
+  {
+    count += memcmp(setting.data, setting.committed, setting.size) != 0;
+  }
+  return count;
+}
+
+void SettingsStore::enableDeferredCommit(u_int32_t quietMs)
+{
+  lock();
+  if (quietMs == 0)
+  {
+    if (m_commitTimer)
+    {
+      xTimerDelete(m_commitTimer, portMAX_DELAY);
+      m_commitTimer = nullptr;
+    }
+  }
+  else if (m_commitTimer == nullptr)
+  {
+    m_commitTimer = xTimerCreate("Settings Commit", pdMS_TO_TICKS(quietMs), pdFALSE, this, settingsStore_timerCallback);
+#ifndef SIMPLEUI_SYNC_RENDER
+    if (m_commitTaskHandle == nullptr)
+    {
+      xTaskCreate(
+          settingsStore_commitTask,
+          "Settings Commit Task",
+          COMMIT_TASK_STACK_SIZE,
+          this,
+          1 | portPRIVILEGE_BIT, // below the input callback tasks, like rendering
+          &m_commitTaskHandle);
+    }
+#endif
+  }
+  else
+  {
+    xTimerChangePeriod(m_commitTimer, pdMS_TO_TICKS(quietMs), portMAX_DELAY);
+    xTimerStop(m_commitTimer, portMAX_DELAY); // changing the period starts the timer
+  }
+  unlock();
+}
+
+void SettingsStore::touch()
+{
+  if (m_commitTimer)
+  {
+    xTimerReset(m_commitTimer, 0);
+  }
+}
+
+void SettingsStore::getStats(SettingsStats &stats) const
+{
+  stats = m_stats;
+  stats.settings = m_settings.size();
+}
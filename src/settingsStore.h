@@ -0,0 +1,163 @@
+#ifndef Futojin_SETTINGS_STORE_H
+#define Futojin_SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Persistent settings. Application variables are bound to keys once; the store keeps a copy of each value
+// as it was last loaded or committed, so a commit finds the changed values by comparison and writes only
+// those, in one backend transaction. Saving costs a memcmp per setting plus one write per changed value,
+// however large the menu is.
+
+#ifndef SIMPLEUI_SETTINGS_QUIET_MS
+#define SIMPLEUI_SETTINGS_QUIET_MS 2000 // deferred commit: time without edits before values are written
+#endif
+#define SETTINGS_KEY_SIZE 16 // NVS keys are limited to 15 characters
+
+/**
+ * Key-value storage behind a SettingsStore. Writes are staged until commit(), which makes them durable
+ * together. Calls are serialized by the store.
+ */
+class SettingsBackend
+{
+public:
+  virtual ~SettingsBackend() {}
+  // Fills data and returns true if key holds a value of exactly size bytes.
+  virtual bool read(const char *key, void *data, size_t size) = 0;
+  virtual bool write(const char *key, const void *data, size_t size) = 0;
+  virtual bool commit() = 0;
+};
+
+#ifdef ESP_PLATFORM
+#include <nvs.h>
+
+// One NVS namespace. The handle is opened on first use and kept open, so a commit is only the writes of the
+// changed values and one nvs_commit().
+class NvsSettingsBackend : public SettingsBackend
+{
+public:
+  NvsSettingsBackend(const char *nvsNamespace);
+  ~NvsSettingsBackend();
+  bool read(const char *key, void *data, size_t size) override;
+  bool write(const char *key, const void *data, size_t size) override;
+  bool commit() override;
+
+private:
+  const char *m_namespace;
+  nvs_handle_t m_handle;
+  bool m_open;
+
+  bool open();
+};
+#endif
+
+// Every value in one file, for host builds and file systems mounted into the VFS. The file is read on first
+// use and rewritten as a whole by commit(), through a temporary file that replaces it.
+class FileSettingsBackend : public SettingsBackend
+{
+public:
+  FileSettingsBackend(const char *path);
+  bool read(const char *key, void *data, size_t size) override;
+  bool write(const char *key, const void *data, size_t size) override;
+  bool commit() override;
+
+private:
+  struct Record
+  {
+    char key[SETTINGS_KEY_SIZE];
+    std::vector<uint8_t> data;
+  };
+
+  const char *m_path;
+  std::vector<Record> m_records;
+  bool m_loaded;
+  bool m_staged; // writes since the last commit
+
+  void load();
+  Record *find(const char *key);
+};
+
+struct SettingsStats
+{
+  u_int16_t settings;      // bound values
+  u_int32_t commits;       // commits that wrote at least one value
+  u_int32_t emptyCommits;  // commits with nothing to write
+  u_int32_t writes;        // values written
+  u_int32_t failures;      // backend writes or commits that failed
+  u_int32_t lastCommitUs;  // duration of the last commit that wrote something
+  u_int32_t maxCommitUs;
+  u_int32_t heapBytes;
+};
+
+/**
+ * Settings bound to application variables.
+ *
+ *   SettingsStore settings(backend);
+ *   settings.bind("volume", volume);
+ *   settings.load();
+ *
+ * Bind every value before load(). Values are compared bytewise, so bind plain data only. Pages can commit
+ * and revert a store from their save actions, or touch() it after every item edit for a deferred commit. A
+ * store shared by several pages with save actions should bind each value with its page as owner, so exit
+ * only reverts that page's values.
+ */
+class SettingsStore
+{
+  friend void settingsStore_timerCallback(TimerHandle_t timer);
+  friend void settingsStore_commitTask(void *parameter);
+
+public:
+  SettingsStore(SettingsBackend &backend);
+  ~SettingsStore();
+  SettingsStore(const SettingsStore &) = delete;
+  SettingsStore &operator=(const SettingsStore &) = delete;
+
+  // owner, usually the page that edits the value, limits revert(owner) to the values it bound.
+  template <typename T>
+  bool bind(const char *key, T &value, const void *owner = nullptr) { return bind(key, &value, sizeof(T), owner); }
+  bool bind(const char *key, void *data, size_t size, const void *owner = nullptr);
+  // Reads every bound value the backend holds. Missing values keep their current content.
+  void load();
+  // Writes the values that differ from the last load or commit, in one transaction. Values are only recorded
+  // as committed once the backend commit succeeded; after a failure they stay dirty and the next commit
+  // retries them.
+  bool commit();
+  // Restores the values of the last load or commit.
+  void revert();
+  // Same for the values bound with owner or without one, leaving those of other owners alone.
+  void revert(const void *owner);
+  size_t dirtyCount() const;
+
+  // Commits once no touch() happened for quietMs. 0 disables it. The commit runs in a task of its own, created
+  // on first use (3 KB of stack), so slow flash writes don't delay other timers. SIMPLEUI_SYNC_RENDER builds
+  // commit in the timer service task instead.
+  void enableDeferredCommit(u_int32_t quietMs = SIMPLEUI_SETTINGS_QUIET_MS);
+  // A bound value may have changed: restarts the quiet period of a deferred commit.
+  void touch();
+
+  void getStats(SettingsStats &stats) const;
+
+private:
+  struct Setting
+  {
+    char key[SETTINGS_KEY_SIZE];
+    void *data;
+    uint8_t *committed; // value as last loaded or committed
+    uint8_t *staged;    // value being written by commit()
+    size_t size;
+    bool written;       // staged was written in the current commit
+    const void *owner;
+  };
+
+  SettingsBackend &m_backend;
+  std::vector<Setting> m_settings;
+  SemaphoreHandle_t m_lock;
+  TimerHandle_t m_commitTimer;
+  TaskHandle_t m_commitTaskHandle;
+  SettingsStats m_stats;
+
+  void lock();
+  void unlock();
+};
+
+#endif // Futojin_SETTINGS_STORE_H
@@ -1,12 +1,19 @@
 #ifndef Futojin_SIMPLEUI_H
 #define Futojin_SIMPLEUI_H
 
-#include "SH1106Wire.h"
+#include "display.h"
+#include "frameMirror.h"
 #include "internal.h"
 #include "icon.h"
+#include "navigation.h"
+#include "settingsStore.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "transition.h"
 #include <vector>
-#include <list>
 
+// Synchronous debug output, for the page logic. Input decoding, event dispatch and rendering use the
+// non-blocking SIMPLEUI_TRACE (see trace.h) instead.
 // #define DEBUG_SIMPLEUI(fmt, ...) Serial.printf(fmt, ##__VA_ARGS__)
 #ifndef DEBUG_SIMPLEUI
 #define DEBUG_SIMPLEUI(...)
@@ -25,18 +32,159 @@ enum Event_ID
   EVENT_PIR,
   EVENT_TIM,
   EVENT_ROT,
-  EVENT_YIELD // internal event, do not use.
+  EVENT_YIELD, // internal event, do not use.
+  EVENT_APP    // first application event id, see EventBus
 };
 
+// Application event ids: const Event_ID EVENT_MODE = APP_EVENT(0);
+#define APP_EVENT(n) ((Event_ID)(EVENT_APP + (n)))
+
 struct Event
 {
   Event_ID eventId;
   unsigned long value;
 };
 
+enum RESOURCE_TASK
+{
+  RESOURCE_TASK_ROTARY_ISR,
+  RESOURCE_TASK_ROTARY_CALLBACK,
+  RESOURCE_TASK_SWITCH_CALLBACK,
+  RESOURCE_TASK_RENDER,
+  RESOURCE_TASK_COUNT
+};
+
+enum RESOURCE_QUEUE
+{
+  RESOURCE_QUEUE_ROTARY_ISR,
+  RESOURCE_QUEUE_ROTARY_CALLBACK,
+  RESOURCE_QUEUE_SWITCH_CALLBACK,
+  RESOURCE_QUEUE_COUNT
+};
+
+enum RESOURCE_TIMER
+{
+  RESOURCE_TIMER_SWITCH_DEBOUNCE,
+  RESOURCE_TIMER_PERF_OVERLAY,
+  RESOURCE_TIMER_SCREEN_SAVER,
+  RESOURCE_TIMER_COUNT
+};
+
+struct TaskStats
+{
+  const char *name; // short label, fits a diagnostics row
+  u_int32_t stackSize;          // bytes requested at creation
+  u_int32_t stackHighWaterMark; // minimum free stack seen so far. 0 if the task does not exist.
+  bool created;
+};
+
+struct QueueStats
+{
+  const char *name;
+  u_int16_t length;
+  u_int16_t depth; // messages currently waiting
+  u_int16_t peak;  // highest depth observed after a send
+  u_int32_t dropped;
+};
+
+struct TimerStats
+{
+  const char *name;
+  u_int32_t periodMs;
+  bool active;
+};
+
+struct ResourceStats
+{
+  TaskStats tasks[RESOURCE_TASK_COUNT];
+  QueueStats queues[RESOURCE_QUEUE_COUNT];
+  TimerStats timers[RESOURCE_TIMER_COUNT];
+  u_int32_t heapBytes;       // heap owned by this container: objects, pages, task stack, timers
+  u_int32_t sharedHeapBytes; // rotary and switch tasks and queues, shared by every container
+  u_int32_t freeHeap;  // system free heap
+};
+
+// Why a frame was drawn, for Container::getBusStats().
+enum DRAW_CAUSE
+{
+  DRAW_CAUSE_ROTARY,
+  DRAW_CAUSE_PUSH,
+  DRAW_CAUSE_SCREENSAVER,
+  DRAW_CAUSE_EXTERNAL, // application events, start(), flipDisplay()
+  DRAW_CAUSE_COUNT
+};
+
+struct BusCauseStats
+{
+  u_int32_t frames;
+  u_int32_t emptyFrames;  // frames where display() had no changed pixels to send
+  u_int32_t bytes;        // estimated bus bytes, including addressing, control bytes and commands
+  u_int32_t transactions; // estimated bus transactions
+  u_int32_t flushUs;      // total time spent in display()
+  u_int32_t maxFlushUs;
+};
+
+struct BusStats
+{
+  BusCauseStats causes[DRAW_CAUSE_COUNT]; // a frame merging several causes is counted under the first one
+  BusCauseStats total;
+  u_int32_t skippedFrames; // draw requests merged into another frame
+  u_int16_t fps;           // frames drawn during the last full second
+};
+
+#ifndef SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS
+#define SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS 2
+#endif
+#ifndef SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS
+#define SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS 30
+#endif
+
+// What the adaptive debounce learned about one switch, see SwitchDebounce::enableAdaptiveDebounce().
+struct SwitchDebounceStats
+{
+  u_int32_t edges;        // interrupts, bounces included
+  u_int32_t bursts;       // presses and releases measured
+  u_int32_t lastBounceUs; // first to last edge of the latest press or release
+  u_int32_t maxBounceUs;
+  u_int32_t estimateUs;   // decaying maximum of the bounce durations, the window is derived from it
+  u_int32_t doubleFires;  // presses or releases reported more than once: the window was too short
+  u_int16_t windowMs;     // debounce window in use
+  bool adaptive;
+};
+
+/**
+ * Order statistics over the enabled flags of a sequence of pages or items.
+ * Toggling a flag, counting the enabled entries before a position (rank) and finding the k-th enabled entry
+ * (select) are all O(log n), so navigation cost does not depend on how many entries are disabled.
+ */
+class EnabledIndex
+{
+public:
+  static const size_t npos = (size_t)-1;
+
+  EnabledIndex() : m_count(0) {}
+  void push_back(bool enabled);
+  void set(size_t pos, bool enabled);
+  void clear();
+  size_t size() const { return m_enabled.size(); }
+  size_t count() const { return m_count; }
+  bool isEnabled(size_t pos) const { return pos < m_enabled.size() && m_enabled[pos]; }
+  size_t rank(size_t pos) const;   // number of enabled entries before pos
+  size_t select(size_t k) const;   // position of the k-th (0-based) enabled entry, or npos
+  size_t next(size_t pos) const;   // first enabled position after pos, or npos
+  size_t prev(size_t pos) const;   // last enabled position before pos, or npos
+  size_t heapUsage() const;
+
+private:
+  std::vector<u_int16_t> m_tree;
+  std::vector<bool> m_enabled;
+  size_t m_count;
+};
+
 class Item
 {
   friend class Page;
+  friend class EventBus;
 
 public:
   char *value;
@@ -45,17 +193,22 @@ public:
   Item(const char *label, void (*onValueChange)(Item *item, const Event *event));
   void (*onValueChange)(Item *item, const Event *event);
   bool isEnabled() const { return m_enabled; }
-  void setEnabled(bool enabled) { m_enabled = enabled; }
+  void setEnabled(bool enabled);
 
 protected:
-  SH1106Wire *m_display;
+  SimpleUIDisplay *m_display;
   bool m_enabled;
+  Page *m_owner;          // page notified of enabled changes, if any
+  u_int16_t m_position;   // position of this item in m_owner
 
   void onEvent(Event &event);
   virtual void draw(u_int16_t idx) = 0;
   virtual void drawHighlight(u_int16_t idx) = 0;
   virtual void drawValueHighlight(u_int16_t idx) = 0;
-  void syncDisplay(SH1106Wire *display) { m_display = display; }
+  // Draws what changed since the last draw() or drawUpdate(), on top of the frame on screen.
+  virtual void drawUpdate(u_int16_t idx) {}
+  void requestUpdate(); // schedules drawUpdate() if the owning page is on screen
+  void syncDisplay(SimpleUIDisplay *display) { m_display = display; }
 };
 
 class PageItem : public Item
@@ -80,69 +233,215 @@ private:
   void drawValueHighlight(u_int16_t idx) override;
 };
 
+#define GRAPH_DEFAULT_SAMPLES 128
+#define GRAPH_LABEL_SIZE 12
+
+enum GRAPH_MODE
+{
+  GRAPH_SCROLL, // the plot moves one column to the left per sample
+  GRAPH_SWEEP   // the newest sample is drawn at a cursor that wraps around, nothing else moves
+};
+
+/**
+ * Plot of the latest samples, shown by a HeroPage. push() stores a sample in a fixed-size ring in O(1) and
+ * never blocks; samples must come from one task at a time. Each push only redraws what changed: the new
+ * columns, the latest value, and the min/max labels when the scale changes.
+ */
+class GraphItem : public HeroPageItem
+{
+public:
+  GraphItem(const char *label, size_t capacity = GRAPH_DEFAULT_SAMPLES, GRAPH_MODE mode = GRAPH_SCROLL,
+            void (*onValueChange)(Item *item, const Event *event) = nullptr);
+  ~GraphItem();
+  // May be called from any task. Producers take a mutex of their own; drawing reads the ring without it.
+  void push(float sample);
+  void setRange(float min, float max); // fixed scale. Without it, the scale follows the samples on screen
+  void setDecimals(u_int8_t decimals) { m_decimals = decimals; }
+  size_t count() const;
+
+private:
+  float *m_samples;
+  size_t m_capacity;
+  u_int32_t m_head; // samples pushed so far, the newest one is at (m_head - 1) % m_capacity
+  SemaphoreHandle_t m_pushMutex;
+  GRAPH_MODE m_mode;
+  bool m_autoscale;
+  float m_rangeMin;
+  float m_rangeMax;
+  u_int8_t m_decimals;
+
+  // What is on screen, so an update only draws the difference
+  bool m_drawn;
+  u_int32_t m_drawnHead;
+  float m_drawnMin;
+  float m_drawnMax;
+  int16_t m_lastY; // plot row of the newest sample on screen
+  u_int16_t m_valueWidth;
+  char m_valueLabel[GRAPH_LABEL_SIZE];
+  char m_minLabel[GRAPH_LABEL_SIZE];
+  char m_maxLabel[GRAPH_LABEL_SIZE];
+
+  TransitionRect plotRect() const;
+  float sample(u_int32_t index) const { return m_samples[index % m_capacity]; }
+  void scale(u_int32_t head, u_int16_t columns, float &min, float &max) const;
+  int16_t plotY(float value, float min, float max, const TransitionRect &plot) const;
+  void drawPlot(u_int32_t head, float min, float max);
+  void drawScaleLabels(float min, float max);
+  void drawValueLabel(u_int32_t head);
+  void draw(u_int16_t idx) override;
+  void drawHighlight(u_int16_t idx) override;
+  void drawValueHighlight(u_int16_t idx) override;
+  void drawUpdate(u_int16_t idx) override;
+};
+
 class Navbar
 {
   friend class Container;
 
 public:
 private:
-  SH1106Wire *m_display;
-  std::vector<Page *> m_pages;
+  SimpleUIDisplay *m_display;
   CONTEXT m_context;
   Container *m_container;
 
-  Navbar(SH1106Wire &display, Container &container);
-  void addPage(Page &page);
-  void draw(const Page &currentPage);
-  void onEvent(Event &event);
+  struct Window
+  {
+    size_t firstRank; // rank of the leftmost icon among the enabled pages
+    size_t slots;     // icons that fit
+    int16_t x0;       // left edge of the first icon
+    int16_t y;
+    bool overflow;    // more enabled pages than slots
+  };
+
+  Navbar(SimpleUIDisplay &display, Container &container);
+  bool window(Window &window) const;
+  bool highlightRect(TransitionRect &rect) const;
+  void draw();
+  void drawOverflowIndicator(int16_t x, int16_t y, bool left);
+};
+
+// Where a page shows its selection, so the container can animate between two of its frames.
+struct PageSelection
+{
+  TransitionRect viewport;  // area the content scrolls in
+  int32_t scrollY;          // position of the content, in pixels
+  TransitionRect highlight; // highlight outline, in screen coordinates
 };
 
+#ifndef SIMPLEUI_EDIT_VALUE_SIZE
+#define SIMPLEUI_EDIT_VALUE_SIZE 24 // longest item value kept by an edit transaction, with its terminator
+#endif
+
 class Page
 {
   friend class Container;
+  friend class Item;
+  friend class EventBus;
 
 public:
   Page(const unsigned char *icon);
-  void enable(bool enabled) { m_enabled = enabled; }
+  void enable(bool enabled);
   bool enabled() const { return m_enabled; }
   void enableSaveActions(void (*onSave)(), void (*onExit)());
+  // Save commits settings, exit reverts them; onExit runs after the revert.
+  void enableSaveActions(SettingsStore &settings, void (*onExit)() = nullptr);
   void disableSaveActions();
+  // Item edits touch settings, for its deferred commit. Pages with save actions commit on save instead.
+  void bindSettings(SettingsStore *settings) { m_settings = settings; }
+  void invalidate() { m_active = false; } // re-read values next time the page is shown
+  bool active() const { return m_active; }
+  // Edit transaction of a page with save actions: the items whose value changed since the last save or exit,
+  // for onSave() to store only those. Only complete if editsTracked().
+  size_t editedCount() const { return m_edits.size(); }
+  Item *editedItem(size_t index) const { return m_edits[index].item; }
+  bool editsTracked() const { return m_editsTracked; }
 
   const unsigned char *getIcon() const { return m_icon; }
+  virtual size_t heapUsage() const { return 0; }
 
 protected:
-  SH1106Wire *m_display;
+  SimpleUIDisplay *m_display;
   Container *m_container;
   const unsigned char *m_icon;
   CONTEXT m_context;
   bool m_enabled;
   bool m_enableSaveActions;
+  SettingsStore *m_settings;
+  bool m_active; // start() has run since the page was last invalidated
+  u_int16_t m_position; // position of this page in m_container
+
+  // Value of an item before its first edit since the last save or exit.
+  struct EditRecord
+  {
+    Item *item;
+    bool truncated; // longer than SIMPLEUI_EDIT_VALUE_SIZE - 1: counts as changed
+    char value[SIMPLEUI_EDIT_VALUE_SIZE];
+  };
+  std::vector<EditRecord> m_edits; // capacity is kept between transactions
+  u_int32_t m_editCount;           // item_edit() calls, to find input that bypassed it
+  bool m_editsTracked;             // every edit of the transaction went through item_edit()
 
   virtual void drawItems() = 0;
   virtual void syncDisplay() = 0;
   virtual void start() = 0;
   virtual void reset() = 0;
-  virtual void onPageEvent(Event &event) = 0;
-  virtual void onItemEvent(Event &event) = 0;
-
+  // Input is handled by Container::navigate() from the table in navigation.cpp. Built-in page kinds only
+  // provide the primitives below; PAGE_NAVIGATION_CUSTOM pages handle onPageEvent() and onItemEvent() and
+  // set m_context themselves, NONE returning to the navbar.
+  virtual u_int8_t navigation() const { return PAGE_NAVIGATION_CUSTOM; }
+  virtual bool hasItems() const { return false; }
+  virtual bool moveSelection(int8_t step) { return false; } // true if the selection moved
+  virtual void onItemInput(Event &event) {}
+  virtual void onPageEvent(Event &event) {}
+  virtual void onItemEvent(Event &event) {}
+  virtual void onItemEnabledChanged(u_int16_t position, bool enabled) {}
+  // Pages with a movable highlight report it here; transitions of other pages are cuts.
+  virtual bool selection(PageSelection &selection) const { return false; }
+  // Draws what changed in the items since the frame on screen. See Item::drawUpdate().
+  virtual void drawUpdate() {}
+  // Event published on an EventBus the page subscribed to. By default the values are re-read: at once if the
+  // page is on screen, otherwise the next time it is shown.
+  virtual void onBusEvent(const Event &event);
+  // Position of the selection, for Container::saveSnapshot(). restoreCursor() rejects one the page cannot show.
+  virtual u_int32_t cursor() const { return 0; }
+  virtual bool restoreCursor(u_int32_t cursor) { return cursor == 0; }
+
+  void activate();
   void drawSaveActions();
+  bool saveActionHighlight(TransitionRect &rect) const; // outline of the selected save or exit icon
   void draw();
-  void onEvent(Event &event);
-  void onSaveEvent(Event &event);
-  void onExitEvent(Event &event);
+  void itemInput(Event &event, bool custom);
+  void commitEdits();
+  void discardEdits();
+  void touchSettings();
+  void recordEdit(Item &item);
+  void pruneEdits();
+  void clearEdits();
 
   void (*onSave)();
   void (*onExit)();
 
   // Helper functions to call Item's non-public methods from Page subclass without declaring them as friend.
   void item_onEvent(Item &item, Event &event) { item.onEvent(event); }
+  // Item input from the encoder: as item_onEvent(), recorded in the edit transaction first.
+  void item_edit(Item &item, Event &event)
+  {
+    recordEdit(item);
+    item.onEvent(event);
+  }
   void item_syncDisplay(Item &item) { item.syncDisplay(m_display); }
   void item_draw(Item &item, u_int16_t idx) { item.draw(idx); }
   void item_drawHighlight(Item &item, u_int16_t idx) { item.drawHighlight(idx); }
   void item_drawValueHighlight(Item &item, u_int16_t idx) { item.drawValueHighlight(idx); }
+  void item_drawUpdate(Item &item, u_int16_t idx) { item.drawUpdate(idx); }
+  void item_attach(Item &item, u_int16_t position)
+  {
+    item.m_owner = this;
+    item.m_position = position;
+  }
 
 private:
-  void checkAndYield();
+  void requestUpdate();
 };
 
 class HeroPage : public Page
@@ -155,44 +454,145 @@ private:
   HeroPageItem *m_currentItem;
 
   void drawItems() override;
+  void drawUpdate() override;
   void start() override;
   void syncDisplay() override;
   void reset() override;
-  void onPageEvent(Event &event) override;
-  void onItemEvent(Event &event) override;
+  u_int8_t navigation() const override { return PAGE_NAVIGATION_HERO; }
+  bool hasItems() const override { return m_currentItem != nullptr; }
+  void onItemInput(Event &event) override;
 };
 
 class ListPage : public Page
 {
 public:
-  ListPage(const unsigned char *icon) : Page(icon) {}
+  ListPage(const unsigned char *icon) : Page(icon), m_currentIdx(0) {}
   void addItem(PageItem &pageItem);
 
 private:
-  std::list<PageItem *> m_pageItems;
-  std::list<PageItem *>::iterator m_currentItemIt;
+  std::vector<PageItem *> m_pageItems;
+  EnabledIndex m_enabledItems;
+  size_t m_currentIdx;
 
   bool nextItem();
   bool prevItem();
+  size_t firstVisibleRank() const;
   void drawItems() override;
   void start() override;
-  void onPageEvent(Event &event) override;
-  void onItemEvent(Event &event) override;
+  u_int8_t navigation() const override { return PAGE_NAVIGATION_LIST; }
+  bool hasItems() const override { return !m_pageItems.empty(); }
+  bool moveSelection(int8_t step) override { return step > 0 ? nextItem() : prevItem(); }
+  void onItemInput(Event &event) override;
   void syncDisplay() override;
   void reset() override;
+  void onItemEnabledChanged(u_int16_t position, bool enabled) override;
+  bool selection(PageSelection &selection) const override;
+  u_int32_t cursor() const override { return m_currentIdx; }
+  bool restoreCursor(u_int32_t cursor) override;
+  size_t heapUsage() const override;
 };
 
+/**
+ * Rows of a VirtualListPage. Only the rows currently on screen are requested.
+ * Returned strings only need to stay valid until the next call into the data source.
+ */
+class ListDataSource
+{
+public:
+  virtual ~ListDataSource() {}
+  virtual size_t count() = 0;
+  virtual const char *label(size_t row) = 0;
+  virtual const char *value(size_t row) = 0;
+  // Rotary events while the row is being edited. Same events an Item's onValueChange receives.
+  virtual void onRowEvent(size_t row, const Event *event) {}
+};
+
+#define VIRTUAL_LIST_DEFAULT_CACHE_ROWS 5
+#define VIRTUAL_LIST_LABEL_SIZE 24
+#define VIRTUAL_LIST_VALUE_SIZE 16
+
+class VirtualListPage : public Page
+{
+public:
+  VirtualListPage(const unsigned char *icon, ListDataSource &source, u_int8_t cacheRows = VIRTUAL_LIST_DEFAULT_CACHE_ROWS);
+  ~VirtualListPage();
+  void invalidate();           // data source content changed
+  void invalidate(size_t row); // a single row changed
+  size_t currentRow() const { return m_currentRow; }
+
+private:
+  struct CachedRow
+  {
+    size_t row;
+    bool valid;
+    char label[VIRTUAL_LIST_LABEL_SIZE];
+    char value[VIRTUAL_LIST_VALUE_SIZE];
+  };
+
+  ListDataSource *m_source;
+  CachedRow *m_cache;
+  u_int8_t m_cacheRows;
+  size_t m_currentRow;
+
+  const CachedRow *fetchRow(size_t row);
+  size_t firstVisibleRow() const;
+  void drawRow(size_t row, u_int16_t drawIdx);
+  void drawItems() override;
+  void start() override;
+  void syncDisplay() override {}
+  void reset() override;
+  u_int8_t navigation() const override { return PAGE_NAVIGATION_LIST; }
+  bool hasItems() const override { return m_source->count() > 0; }
+  bool moveSelection(int8_t step) override;
+  void onItemInput(Event &event) override;
+  bool selection(PageSelection &selection) const override;
+  u_int32_t cursor() const override { return m_currentRow; }
+  bool restoreCursor(u_int32_t cursor) override;
+  size_t heapUsage() const override;
+};
+
+class DiagnosticsPage : public Page
+{
+public:
+  DiagnosticsPage(const unsigned char *icon) : Page(icon), m_firstRow(0) {}
+
+private:
+  u_int8_t m_firstRow;
+
+  void drawItems() override;
+  void start() override {}
+  void syncDisplay() override {}
+  void reset() override;
+  u_int32_t cursor() const override { return m_firstRow; }
+  bool restoreCursor(u_int32_t cursor) override;
+  u_int8_t navigation() const override { return PAGE_NAVIGATION_SCROLL; }
+  bool moveSelection(int8_t step) override;
+};
+
+#define PERF_OVERLAY_LINE_SIZE 20
+#ifndef PERF_OVERLAY_HOLD_MS
+#define PERF_OVERLAY_HOLD_MS 3000
+#endif
+
 class Container
 {
   friend class Navbar;
   friend class Page;
-  friend void onContainerRotaryEvent(ROTARY_EVENT rEvent);
-  friend void onContainerSwitchEvent(u_int8_t pinState);
+  friend class EventBus;
+  friend void onContainerRotaryEvent(ROTARY_EVENT rEvent, void *arg);
+  friend void onContainerSwitchEvent(u_int8_t pinState, void *arg);
+  friend void onContainerRenderTask(void *parameter);
+  friend void onContainerPerfOverlayTimer(TimerHandle_t timer);
+  friend void onContainerScreenSaverTimer(TimerHandle_t timer);
+  friend struct SimpleUIBench;
 
 public:
   // Singleton
-  static Container &getInstance(SH1106Wire &display);
-  static Container &getInstance(SH1106Wire &display, u_int8_t tra, u_int8_t trb, u_int8_t psh);
+  static Container &getInstance(SimpleUIDisplay &display);
+  static Container &getInstance(SimpleUIDisplay &display, u_int8_t tra, u_int8_t trb, u_int8_t psh);
+  // Additional containers, one per display. Each one has its own input bindings and render task.
+  static Container &create(SimpleUIDisplay &display);
+  static Container &create(SimpleUIDisplay &display, u_int8_t tra, u_int8_t trb, u_int8_t psh);
   Container(const Container &) = delete;
   Container &operator=(const Container &) = delete;
 
@@ -204,57 +604,223 @@ public:
   void disableScreenSaver();
   void start();
   void flipDisplay(bool flipVertical);
+  void enablePrefetch(bool enabled) { m_prefetch = enabled; }
+  void getResourceStats(ResourceStats &stats) const;
+  void getBusStats(BusStats &stats) const;
+  void resetBusStats();
+  // Frame time, fps, flush bytes, dropped input events and free heap in the bottom-right corner, refreshed
+  // once per second.
+  void enablePerfOverlay(bool enabled);
+  bool perfOverlayEnabled() const { return m_perfOverlay.enabled; }
+  // Holding the push button for PERF_OVERLAY_HOLD_MS toggles the overlay. The press is still handled as a
+  // normal push.
+  void enablePerfOverlayGesture(bool enabled) { m_perfOverlay.gesture = enabled; }
+  // Push button debounce, see SwitchDebounce::enableAdaptiveDebounce(). Stats are zero without a switch.
+  void enableAdaptiveDebounce(u_int16_t minMs = SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS, u_int16_t maxMs = SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS);
+  void getSwitchStats(SwitchDebounceStats &stats) const;
+  // Animate page switches, list scrolling and highlight moves over durationMs. Steps are drawn by the render
+  // task, so builds with SIMPLEUI_SYNC_RENDER always switch at once.
+  void enableTransitions(bool enabled, u_int16_t durationMs = SIMPLEUI_TRANSITION_MS);
+  // Navigation state (current page, contexts, the page's selection) and, withFrame, the frame on screen.
+  // saveSnapshot() returns the bytes written, 0 if size is smaller than snapshotSize().
+  size_t snapshotSize(bool withFrame = true) const;
+  size_t saveSnapshot(uint8_t *data, size_t size, bool withFrame = true);
+  bool saveSnapshot(SnapshotStore &store, bool withFrame = true);
+  // Call after addPage() and initDisplay(), before start(). A saved frame is sent to the panel as is, and
+  // start() then skips the first frame. Returns false, changing nothing, if the snapshot does not match the
+  // pages of this container.
+  bool restoreSnapshot(const uint8_t *data, size_t size);
+  bool restoreSnapshot(SnapshotStore &store);
+  // Every flushed frame also goes to mirror (nullptr: none), starting with a keyframe of the next frame.
+  void setMirror(FrameMirror *mirror);
 
 private:
-  struct WatchdogTaskParams
+  struct PerfOverlay
+  {
+    bool enabled;
+    bool gesture;
+    unsigned long pushStartMs;
+    TimerHandle_t refreshTimer;
+    u_int32_t frameUs;     // render and flush time of the last full frame
+    u_int32_t frameBytes;  // bus bytes of the last full frame
+    u_int16_t width;       // width of the drawn box, so a refresh clears what the previous one drew
+    char lines[2][PERF_OVERLAY_LINE_SIZE];
+  };
+
+  // What an event can animate, compared before and after the event is handled.
+  struct TransitionState
   {
-    Container *container;
+    size_t idx;
+    bool navbar; // navbarHighlight is valid
+    TransitionRect navbarHighlight;
+    bool page; // selection is valid
+    PageSelection selection;
+    bool saveAction; // saveActionHighlight is valid
+    TransitionRect saveActionHighlight;
+    bool highlight(TransitionRect &rect) const; // outline of the current context, if its position is known
   };
 
-  SH1106Wire *m_display;
+  enum RenderRequest
+  {
+    RENDER_FRAME = 1 << 0,
+    RENDER_BRIGHTNESS = 1 << 1,
+    RENDER_ORIENTATION = 1 << 2,
+    RENDER_OVERLAY = 1 << 3, // refresh the performance overlay only, on top of the last frame
+    RENDER_UPDATE = 1 << 4,  // items of the current page draw what changed, on top of the last frame
+    // Causes, only used for bus accounting
+    RENDER_CAUSE_ROTARY = 1 << 8,
+    RENDER_CAUSE_PUSH = 1 << 9,
+    RENDER_CAUSE_SCREENSAVER = 1 << 10
+  };
+
+  SimpleUIDisplay *m_display;
   Page *m_currentPage;
   Navbar m_navbar;
   CONTEXT m_context;
   std::vector<Page *> m_pages;
-  u_int8_t m_idx;
-  TaskHandle_t m_watchdogTaskHandle;
+  EnabledIndex m_enabledPages;
+  size_t m_idx;
+  TimerHandle_t m_screenSaverTimer; // one-shot, restarted by every event: no wakeups while idle
   u_int8_t m_screenBrightness;
   u_int8_t m_screenSaverTimeoutSec;
   volatile unsigned long m_lastActivityMs;
   RotaryDebounce *m_rotaryDebounce;
   SwitchDebounce *m_switchDebounce;
+  TaskHandle_t m_renderTaskHandle;
+  SemaphoreHandle_t m_stateMutex; // guards navigation state and bus stats between event handling and the render task
+  bool m_flipVertical;
+  bool m_prefetch;
+  BusStats m_busStats;
+  u_int32_t m_drawRequests; // requestDraw() calls, to count the ones merged into a single frame; atomic
+  u_int32_t m_drawnRequests;
+  unsigned long m_fpsWindowStartMs;
+  u_int16_t m_fpsWindowFrames;
+  PerfOverlay m_perfOverlay;
+  FrameTransition m_transition;
+  TransitionHint m_transitionHint;  // what the next frame changes, merged over the events it serves
+  u_int32_t m_transitionRequests;   // causes of the frame the running transition leads to
+  u_int16_t m_transitionMs;         // 0: transitions off
+  bool m_updatePending;             // an item update arrived during a transition
+  bool m_frameRestored;             // the panel shows a frame from restoreSnapshot()
+  FrameMirror *m_mirror;
 
-  static WatchdogTaskParams s_watchdogTaskParams;
   static Container *s_containerInstance;
 
   void drawOverlay();
-  void draw();
+  void draw(u_int32_t requests = RENDER_FRAME);
+  void requestDraw(u_int32_t requests = RENDER_FRAME);
+  bool drawTransitionStep();
+  u_int32_t flush(u_int32_t requests, u_int32_t commands);
+  void accountFlush(u_int32_t requests, bool changed, u_int32_t flushUs, u_int32_t bytes, u_int32_t transactions);
+  static u_int32_t eventCause(const Event &event);
+  void updatePerfOverlay();
+  void drawPerfOverlay();
+  TransitionRect perfOverlayRect() const;
+  void transitionState(TransitionState &state) const;
+  void noteTransition(const TransitionState &before);
+  void mergeTransition(const TransitionHint &next);
+  TransitionRect pageArea() const;
+  void createRenderTask();
+  void lockState() const { xSemaphoreTakeRecursive(m_stateMutex, portMAX_DELAY); }
+  void unlockState() const { xSemaphoreGiveRecursive(m_stateMutex); }
   void trackCurrentPage(ROTARY_EVENT rEvent);
-  void onEventYield(Event &event);
-  void createWatchdogTask();
-  static void onWatchdogTask(void *parameter);
-  void screenSaverTask(WatchdogTaskParams *params);
-  u_int8_t nextEnabledPage();
-  u_int8_t previousEnabledPage();
-
-  Container(SH1106Wire &display);
-  Container(SH1106Wire &display, u_int8_t tra, u_int8_t trb, u_int8_t psh);
+  void showPage(size_t idx);
+  void prefetchNeighbours();
+  void navigate(ROTARY_EVENT input);
+  bool navigationGuard(u_int8_t guard, ROTARY_EVENT input);
+  void restartScreenSaver();
+  size_t nextEnabledPage();
+  size_t previousEnabledPage();
+  void onPageEnabledChanged(u_int16_t position, bool enabled);
+
+  Container(SimpleUIDisplay &display);
+  Container(SimpleUIDisplay &display, u_int8_t tra, u_int8_t trb, u_int8_t psh);
   ~Container();
 };
 
+#ifndef SIMPLEUI_EVENT_BUS_SUBSCRIBERS
+#define SIMPLEUI_EVENT_BUS_SUBSCRIBERS 16
+#endif
+#define EVENT_BUS_IDS 32 // event ids an EventFilter can select
+#define EVENT_MASK(id) (1UL << (id))
+
+// Which published events reach a subscriber: the event id is in events, and (value & valueMask) == valueMatch.
+struct EventFilter
+{
+  u_int32_t events; // EVENT_MASK() of each event id
+  unsigned long valueMask;
+  unsigned long valueMatch;
+
+  EventFilter(u_int32_t events, unsigned long valueMask = 0, unsigned long valueMatch = 0)
+      : events(events), valueMask(valueMask), valueMatch(valueMatch) {}
+};
+
+/**
+ * Publish/subscribe for application events (APP_EVENT(), EVENT_PIR, EVENT_TIM), so any number of
+ * items and pages can react to a mode change or a sensor fault without the application walking the menu.
+ * Subscribers live in a fixed table of SIMPLEUI_EVENT_BUS_SUBSCRIBERS entries: publish() allocates nothing
+ * and costs one filter check per subscriber. Subscribers are called in the publishing task, in subscription
+ * order, with the state of their container locked. Do not publish from an ISR.
+ */
+class EventBus
+{
+public:
+  EventBus();
+  ~EventBus();
+  // The item's onValueChange receives the event; the page is redrawn if it is on screen.
+  bool subscribe(Item &item, EventFilter filter);
+  // Page::onBusEvent() receives the event.
+  bool subscribe(Page &page, EventFilter filter);
+  bool subscribe(void (*handler)(const Event &event, void *arg), void *arg, EventFilter filter);
+  // Removes every subscription of an item, a page or a handler argument.
+  void unsubscribe(const void *subscriber);
+  // Returns the number of subscribers the event was delivered to.
+  size_t publish(Event_ID eventId, unsigned long value = 0);
+  size_t subscriberCount() const { return m_count; }
+
+private:
+  enum SUBSCRIBER_KIND
+  {
+    SUBSCRIBER_ITEM,
+    SUBSCRIBER_PAGE,
+    SUBSCRIBER_HANDLER
+  };
+
+  struct Subscriber
+  {
+    u_int32_t events;
+    unsigned long valueMask;
+    unsigned long valueMatch;
+    u_int8_t kind; // SUBSCRIBER_KIND
+    void *target;  // Item, Page or handler argument
+    void (*handler)(const Event &event, void *arg);
+  };
+
+  Subscriber m_subscribers[SIMPLEUI_EVENT_BUS_SUBSCRIBERS];
+  size_t m_count;
+  SemaphoreHandle_t m_lock;
+
+  bool add(u_int8_t kind, void *target, void (*handler)(const Event &event, void *arg), const EventFilter &filter);
+  void deliver(const Subscriber &subscriber, Event &event, Container **redraw, size_t &redraws);
+};
+
 class RotaryDebounce
 {
   friend void IRAM_ATTR rotary_isr(void *arg);
   friend void handleRotaryDebounceQueueTask(void *parameter);
   friend void handleRotaryCallbackTask(void *parameter);
+  friend struct SimpleUIBench;
 
 public:
   /**
    * Note: Rotary encoder pins are assumed to be pulled up HIGH.
    */
   RotaryDebounce(const u_int8_t tra, const u_int8_t trb, void (*onRotaryEvent)(const ROTARY_EVENT event));
+  RotaryDebounce(const u_int8_t tra, const u_int8_t trb, void (*onRotaryEvent)(const ROTARY_EVENT event, void *arg), void *arg);
   ~RotaryDebounce();
   void start();
+  // Tasks and queues, shared by every encoder. Also reported when no encoder exists.
+  static void getResourceStats(ResourceStats &stats);
 
 private:
   u_int8_t m_pinA;
@@ -289,6 +855,8 @@ private:
   } m_rotaryState;
 
   void (*onRotaryEvent)(const ROTARY_EVENT event);
+  void (*onRotaryEventArg)(const ROTARY_EVENT event, void *arg);
+  void *m_callbackArg;
   void abInterrupt(unsigned long interruptMs);
   void resetState();
   void cw(int pinAState, int pinBState);
@@ -302,17 +870,45 @@ class SwitchDebounce
   friend void handleSwitchDebounceIsrQueueTask(void *param);
   friend void handleSwitchDebounceCallbackTask(void *param);
   friend void switchDebounce_timerCallback(TimerHandle_t xTimer);
+  friend struct SimpleUIBench;
 
 public:
   SwitchDebounce(u_int8_t pin, void (*switchEventResponder)(const u_int8_t pinState));
+  SwitchDebounce(u_int8_t pin, void (*switchEventResponder)(const u_int8_t pinState, void *arg), void *arg);
   ~SwitchDebounce();
   void start();
   int getPinState() const { return m_lastPinState; }
+  void getResourceStats(ResourceStats &stats) const;
+  // Callback task and queue, shared by every switch. Also reported when no switch exists.
+  static void getSharedResourceStats(ResourceStats &stats);
+  // Learns the debounce window from the bounce this switch actually shows, within [minMs, maxMs]. Edges
+  // closer than maxMs belong to one press or release, unless a reported change is undone after twice the
+  // window (a quick tap). The window follows their measured spread with a 50% margin, rising at once after
+  // a longer bounce and decaying slowly after shorter ones.
+  void enableAdaptiveDebounce(u_int16_t minMs = SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS, u_int16_t maxMs = SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS);
+  void disableAdaptiveDebounce();
+  u_int16_t debounceMs() const { return m_windowMs; }
+  void getDebounceStats(SwitchDebounceStats &stats) const;
 
 private:
   u_int8_t m_pin;
   int m_lastPinState;
   TimerHandle_t m_debounceTimer;
+  u_int16_t m_windowMs;
+  // Adaptive debounce. Edge times and the estimate are only written by the ISR.
+  bool m_adaptive;
+  u_int16_t m_minMs;
+  u_int16_t m_maxMs;
+  unsigned long m_burstStartUs;
+  unsigned long m_lastEdgeUs;
+  int m_burstStartLevel;      // reported level before the current burst
+  u_int8_t m_burstDispatches; // state changes reported for the current burst
+  SwitchDebounceStats m_stats;
   void (*onSwitchEvent)(const u_int8_t pinState);
+  void (*onSwitchEventArg)(const u_int8_t pinState, void *arg);
+  void *m_callbackArg;
+
+  void dispatch();
+  bool IRAM_ATTR measureEdge(unsigned long nowUs, int level);
 };
 #endif // Futojin_SIMPLEUI_H
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "simpleUI.h"
+
+RTC_DATA_ATTR static uint8_t s_rtcSnapshot[SIMPLEUI_SNAPSHOT_RTC_SIZE];
+RTC_DATA_ATTR static u_int16_t s_rtcSnapshotSize = 0;
+
+bool RtcSnapshotStore::write(const uint8_t *data, size_t size)
+{
+  if (size > sizeof(s_rtcSnapshot))
+  {
+    return false;
+  }
+  memcpy(s_rtcSnapshot, data, size);
+  s_rtcSnapshotSize = size;
+  return true;
+}
+
+size_t RtcSnapshotStore::read(uint8_t *data, size_t size)
+{
+  // After a power cycle the size is garbage or 0; the checksum rejects the content.
+  if (s_rtcSnapshotSize == 0 || s_rtcSnapshotSize > sizeof(s_rtcSnapshot) || s_rtcSnapshotSize > size)
+  {
+    return 0;
+  }
+  memcpy(data, s_rtcSnapshot, s_rtcSnapshotSize);
+  return s_rtcSnapshotSize;
+}
+
+void RtcSnapshotStore::clear()
+{
+  s_rtcSnapshotSize = 0;
+}
+
+// Bitwise CRC-32 (IEEE 802.3): no table, it runs once per sleep and wake.
+u_int32_t snapshotCrc32(const uint8_t *data, size_t size)
+{
+  u_int32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < size; i++)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+static uint8_t *put16(uint8_t *out, u_int16_t value)
+{
+  out[0] = value;
+  out[1] = value >> 8;
+  return out + 2;
+}
+
+static uint8_t *put32(uint8_t *out, u_int32_t value)
+{
+  out = put16(out, value);
+  return put16(out, value >> 16);
+}
+
+static u_int16_t get16(const uint8_t *in)
+{
+  return in[0] | in[1] << 8;
+}
+
+static u_int32_t get32(const uint8_t *in)
+{
+  return get16(in) | (u_int32_t)get16(in + 2) << 16;
+}
+
+size_t Container::snapshotSize(bool withFrame) const
+{
+  size_t frameSize = (size_t)m_display->getWidth() * m_display->getHeight() / 8;
+  return SNAPSHOT_HEADER_SIZE + (withFrame ? frameSize : 0) + SNAPSHOT_CRC_SIZE;
+}
+
+size_t Container::saveSnapshot(uint8_t *data, size_t size, bool withFrame)
+{
+  lockState();
+  // A frame in the middle of a transition is not a frame the pages would draw.
+  withFrame = withFrame && !m_transition.active();
+  size_t total = snapshotSize(withFrame);
+  if (m_currentPage == nullptr || size < total)
+  {
+    unlockState();
+    return 0;
+  }
+
+  uint8_t *out = put32(data, SNAPSHOT_MAGIC);
+  *out++ = SNAPSHOT_VERSION;
+  *out++ = withFrame ? SNAPSHOT_FLAG_FRAME : 0;
+  out = put16(out, m_pages.size());
+  out = put16(out, m_idx);
+  *out++ = m_context;
+  *out++ = m_navbar.m_context;
+  *out++ = m_currentPage->m_context;
+  out = put32(out, m_currentPage->cursor());
+  out = put16(out, m_display->getWidth());
+  out = put16(out, m_display->getHeight());
+  if (withFrame)
+  {
+    size_t frameSize = total - SNAPSHOT_HEADER_SIZE - SNAPSHOT_CRC_SIZE;
+    memcpy(out, m_display->buffer, frameSize);
+    out += frameSize;
+  }
+  put32(out, snapshotCrc32(data, out - data));
+  unlockState();
+  return total;
+}
+
+bool Container::saveSnapshot(SnapshotStore &store, bool withFrame)
+{
+  std::vector<uint8_t> data(snapshotSize(withFrame));
+  size_t size = saveSnapshot(data.data(), data.size(), withFrame);
+  return size > 0 && store.write(data.data(), size);
+}
+
+bool Container::restoreSnapshot(const uint8_t *data, size_t size)
+{
+  if (size < SNAPSHOT_HEADER_SIZE + SNAPSHOT_CRC_SIZE || get32(data) != SNAPSHOT_MAGIC ||
+      data[4] != SNAPSHOT_VERSION || get32(data + size - SNAPSHOT_CRC_SIZE) != snapshotCrc32(data, size - SNAPSHOT_CRC_SIZE))
+  {
+    return false;
+  }
+  bool withFrame = data[5] & SNAPSHOT_FLAG_FRAME;
+  size_t idx = get16(data + 8);
+  CONTEXT context = (CONTEXT)data[10];
+  CONTEXT navbarContext = (CONTEXT)data[11];
+  CONTEXT pageContext = (CONTEXT)data[12];
+  u_int32_t cursor = get32(data + 13);
+  u_int16_t width = get16(data + 17);
+  u_int16_t height = get16(data + 19);
+  if (size != SNAPSHOT_HEADER_SIZE + (withFrame ? (size_t)width * height / 8 : 0) + SNAPSHOT_CRC_SIZE)
+  {
+    return false;
+  }
+  // The menu must be the one the snapshot was taken from.
+  if (get16(data + 6) != m_pages.size() || idx >= m_pages.size() || !m_pages[idx]->enabled() ||
+      (context != NAVBAR && context != PAGE))
+  {
+    return false;
+  }
+
+  lockState();
+  Page *page = m_pages[idx];
+  // Contexts as navigate() leaves them: the navbar, or the page in a context it can be in.
+  bool contexts = context == NAVBAR ? navbarContext == NAVBAR && pageContext == NONE
+                                    : navbarContext == NONE && pageContext >= PAGE && pageContext <= EXIT;
+  if (pageContext == ITEM)
+  {
+    contexts = contexts && (page->navigation() == PAGE_NAVIGATION_CUSTOM || page->hasItems());
+  }
+  else if (pageContext == SAVE || pageContext == EXIT)
+  {
+    contexts = contexts && page->m_enableSaveActions;
+  }
+  if (!contexts || !page->restoreCursor(cursor))
+  {
+    unlockState();
+    return false;
+  }
+  m_idx = idx;
+  m_currentPage = page;
+  m_context = context;
+  m_navbar.m_context = navbarContext;
+  page->m_context = pageContext;
+  m_frameRestored = withFrame && width == m_display->getWidth() && height == m_display->getHeight();
+  if (m_frameRestored)
+  {
+    // The frame goes to the panel as it was saved. The page is started by the first event or frame.
+    memcpy(m_display->buffer, data + SNAPSHOT_HEADER_SIZE, size - SNAPSHOT_HEADER_SIZE - SNAPSHOT_CRC_SIZE);
+    m_display->display();
+  }
+  unlockState();
+  return true;
+}
+
+bool Container::restoreSnapshot(SnapshotStore &store)
+{
+  std::vector<uint8_t> data(snapshotSize(true));
+  size_t size = store.read(data.data(), data.size());
+  return size > 0 && restoreSnapshot(data.data(), size);
+}
@@ -0,0 +1,46 @@
+#ifndef Futojin_SNAPSHOT_H
+#define Futojin_SNAPSHOT_H
+
+#include <Arduino.h>
+
+// Navigation state of a Container, and optionally the frame on screen, in a compact checksummed record:
+//
+//   magic "SUIS"  version  flags  pages  idx  contexts (container, navbar, page)  cursor  width  height
+//   frame (width * height / 8 bytes, if SNAPSHOT_FLAG_FRAME)  CRC-32 of everything before it
+//
+// Multi-byte fields are little endian, so a record does not depend on struct layout or compiler.
+
+#define SNAPSHOT_MAGIC 0x53495553 // "SUIS"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE 21
+#define SNAPSHOT_CRC_SIZE 4
+#define SNAPSHOT_FLAG_FRAME 0x01
+
+#ifndef SIMPLEUI_SNAPSHOT_RTC_SIZE
+#define SIMPLEUI_SNAPSHOT_RTC_SIZE (SNAPSHOT_HEADER_SIZE + 128 * 64 / 8 + SNAPSHOT_CRC_SIZE)
+#endif
+
+// Where Container::saveSnapshot() keeps its record.
+class SnapshotStore
+{
+public:
+  virtual ~SnapshotStore() {}
+  virtual bool write(const uint8_t *data, size_t size) = 0;
+  // Copies the saved record into data and returns its size, 0 if there is none or it does not fit.
+  virtual size_t read(uint8_t *data, size_t size) = 0;
+  virtual void clear() = 0;
+};
+
+// RTC slow memory: survives deep sleep, not a power cycle. One record of up to SIMPLEUI_SNAPSHOT_RTC_SIZE
+// bytes, shared by every instance.
+class RtcSnapshotStore : public SnapshotStore
+{
+public:
+  bool write(const uint8_t *data, size_t size) override;
+  size_t read(uint8_t *data, size_t size) override;
+  void clear() override;
+};
+
+u_int32_t snapshotCrc32(const uint8_t *data, size_t size);
+
+#endif // Futojin_SNAPSHOT_H
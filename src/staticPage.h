@@ -0,0 +1,299 @@
+#ifndef Futojin_STATIC_PAGE_H
+#define Futojin_STATIC_PAGE_H
+
+#include "simpleUI.h"
+#include "itemRenderer.h"
+
+// Static-polymorphism counterparts of Item/PageItem/HeroPageItem and ListPage/HeroPage.
+//
+// StaticListPage<ItemT> knows the concrete item type at compile time, so every per-item draw and event
+// call is a direct (inlinable) call instead of going through Item's vtable and Page's item_* helpers.
+// The pages still derive from Page, so they can be added to the same Container as virtual pages; the
+// only remaining virtual calls are the Page::drawItems entry, once per frame, and the navigation
+// primitives, once per event.
+//
+// Custom static items derive from StaticItem<Derived> and provide drawItem(), drawItemHighlight() and
+// drawItemValueHighlight().
+
+template <typename ItemT>
+class StaticListPage;
+
+template <typename ItemT>
+class StaticHeroPage;
+
+template <typename Derived>
+class StaticItem
+{
+  friend class StaticListPage<Derived>;
+  friend class StaticHeroPage<Derived>;
+
+public:
+  char *value;
+  const char *m_label;
+
+  StaticItem(const char *label, void (*valueChangeResponder)(Derived *item, const Event *event))
+      : value(nullptr),
+        m_label(label),
+        onValueChange(valueChangeResponder),
+        m_display(nullptr),
+        m_enabled(true)
+  {
+  }
+  void (*onValueChange)(Derived *item, const Event *event);
+  bool isEnabled() const { return m_enabled; }
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+
+protected:
+  SimpleUIDisplay *m_display;
+  bool m_enabled;
+
+  void onEvent(Event &event)
+  {
+    if (onValueChange)
+    {
+      DEBUG_SIMPLEUI("StaticItem::onEvent: Calling onValueChange: %d %lu\n", event.eventId, event.value);
+      onValueChange(static_cast<Derived *>(this), &event);
+    }
+  }
+  void draw(u_int16_t idx) { static_cast<Derived *>(this)->drawItem(idx); }
+  void drawHighlight(u_int16_t idx) { static_cast<Derived *>(this)->drawItemHighlight(idx); }
+  void drawValueHighlight(u_int16_t idx) { static_cast<Derived *>(this)->drawItemValueHighlight(idx); }
+  void syncDisplay(SimpleUIDisplay *display) { m_display = display; }
+};
+
+class StaticPageItem : public StaticItem<StaticPageItem>
+{
+  friend class StaticItem<StaticPageItem>;
+
+public:
+  StaticPageItem(const char *label, void (*onValueChange)(StaticPageItem *item, const Event *event))
+      : StaticItem<StaticPageItem>(label, onValueChange)
+  {
+  }
+
+private:
+  void drawItem(u_int16_t idx) { PageItemRenderer::draw(m_display, idx, m_label, value); }
+  void drawItemHighlight(u_int16_t idx) { PageItemRenderer::drawHighlight(m_display, idx); }
+  void drawItemValueHighlight(u_int16_t idx) { PageItemRenderer::drawValueHighlight(m_display, idx, value); }
+};
+
+class StaticHeroPageItem : public StaticItem<StaticHeroPageItem>
+{
+  friend class StaticItem<StaticHeroPageItem>;
+
+public:
+  StaticHeroPageItem(const char *label, void (*onValueChange)(StaticHeroPageItem *item, const Event *event))
+      : StaticItem<StaticHeroPageItem>(label, onValueChange)
+  {
+  }
+
+private:
+  void drawItem(u_int16_t idx) { HeroPageItemRenderer::draw(m_display, m_label, value); }
+  void drawItemHighlight(u_int16_t idx) { drawItemValueHighlight(idx); }
+  void drawItemValueHighlight(u_int16_t idx) { HeroPageItemRenderer::drawValueHighlight(m_display, value); }
+};
+
+template <typename ItemT>
+class StaticListPage : public Page
+{
+public:
+  StaticListPage(const unsigned char *icon) : Page(icon), m_currentIdx(0) {}
+
+  void addItem(ItemT &item)
+  {
+    item.syncDisplay(m_display);
+    m_items.push_back(&item);
+  }
+
+private:
+  std::vector<ItemT *> m_items;
+  size_t m_currentIdx;
+
+  bool nextItem()
+  {
+    for (size_t i = m_currentIdx + 1; i < m_items.size(); i++)
+    {
+      if (m_items[i]->isEnabled())
+      {
+        m_currentIdx = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool prevItem()
+  {
+    for (size_t i = m_currentIdx; i > 0; i--)
+    {
+      if (m_items[i - 1]->isEnabled())
+      {
+        m_currentIdx = i - 1;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void drawItems() override
+  {
+    if (m_items.empty())
+    {
+      return;
+    }
+
+    // Same window as ListPage: current item in the middle of the screen, if possible.
+    ItemT *enabledItems[LIST_PAGE_DRAW_SIZE];
+    size_t first = m_currentIdx;
+    size_t before = 0;
+    for (size_t i = m_currentIdx; i > 0 && before < LIST_PAGE_DRAW_SIZE / 2; i--)
+    {
+      if (m_items[i - 1]->isEnabled())
+      {
+        first = i - 1;
+        before++;
+      }
+    }
+
+    size_t count = 0;
+    for (size_t i = first; i < m_items.size() && count < LIST_PAGE_DRAW_SIZE; i++)
+    {
+      if (m_items[i]->isEnabled())
+      {
+        enabledItems[count++] = m_items[i];
+      }
+    }
+
+    ItemT *current = m_items[m_currentIdx];
+    for (size_t drawIdx = 0; drawIdx < count; drawIdx++)
+    {
+      ItemT *item = enabledItems[drawIdx];
+      item->draw(drawIdx);
+
+      if (item == current)
+      {
+        if (m_context == PAGE)
+        {
+          item->drawHighlight(drawIdx);
+        }
+        else if (m_context == ITEM)
+        {
+          item->drawValueHighlight(drawIdx);
+        }
+      }
+    }
+  }
+
+  bool selection(PageSelection &selection) const override
+  {
+    if (m_context != PAGE || m_items.empty())
+    {
+      return false;
+    }
+    // Same window as drawItems(): up to LIST_PAGE_DRAW_SIZE / 2 enabled items above the current one.
+    size_t rank = 0;
+    for (size_t i = 0; i < m_currentIdx; i++)
+    {
+      rank += m_items[i]->isEnabled() ? 1 : 0;
+    }
+    size_t before = rank < LIST_PAGE_DRAW_SIZE / 2 ? rank : LIST_PAGE_DRAW_SIZE / 2;
+    selection.viewport = PageItemRenderer::viewport(m_display);
+    selection.scrollY = (rank - before) * PAGE_ITEM_DRAW_HEIGHT;
+    selection.highlight = PageItemRenderer::highlightRect(m_display, before);
+    return true;
+  }
+
+  u_int32_t cursor() const override { return m_currentIdx; }
+
+  bool restoreCursor(u_int32_t cursor) override
+  {
+    if (cursor != 0 && (cursor >= m_items.size() || !m_items[cursor]->isEnabled()))
+    {
+      return false;
+    }
+    m_currentIdx = cursor;
+    return true;
+  }
+
+  void start() override
+  {
+    for (ItemT *item : m_items)
+    {
+      Event initEvent = {EVENT_EMPTY, 0};
+      item->onEvent(initEvent);
+    }
+  }
+
+  u_int8_t navigation() const override { return PAGE_NAVIGATION_LIST; }
+  bool hasItems() const override { return !m_items.empty(); }
+  bool moveSelection(int8_t step) override { return step > 0 ? nextItem() : prevItem(); }
+  void onItemInput(Event &event) override { m_items[m_currentIdx]->onEvent(event); }
+
+  void syncDisplay() override
+  {
+    for (ItemT *item : m_items)
+    {
+      item->syncDisplay(m_display);
+    }
+  }
+
+  void reset() override
+  {
+    m_currentIdx = 0;
+  }
+};
+
+template <typename ItemT>
+class StaticHeroPage : public Page
+{
+public:
+  StaticHeroPage(const unsigned char *icon) : Page(icon), m_currentItem(nullptr) {}
+
+  void addItem(ItemT &item)
+  {
+    m_currentItem = &item;
+    item.syncDisplay(m_display);
+  }
+
+private:
+  ItemT *m_currentItem;
+
+  void drawItems() override
+  {
+    if (m_currentItem && m_currentItem->isEnabled())
+    {
+      m_currentItem->draw(0);
+      if (m_context == PAGE || m_context == ITEM)
+      {
+        m_currentItem->drawValueHighlight(0);
+      }
+    }
+  }
+
+  void start() override
+  {
+    if (m_currentItem)
+    {
+      Event initEvent = {EVENT_EMPTY, 0};
+      m_currentItem->onEvent(initEvent);
+    }
+  }
+
+  u_int8_t navigation() const override { return PAGE_NAVIGATION_HERO; }
+  bool hasItems() const override { return m_currentItem != nullptr; }
+  void onItemInput(Event &event) override { m_currentItem->onEvent(event); }
+
+  void syncDisplay() override
+  {
+    if (m_currentItem)
+    {
+      m_currentItem->syncDisplay(m_display);
+    }
+  }
+
+  void reset() override
+  {
+  }
+};
+
+#endif // Futojin_STATIC_PAGE_H
@@ -3,10 +3,16 @@
 
 #define QUEUE_LENGTH 10
 #define DEBOUNCE_TIME_MS 20
+#define ADAPTIVE_DECAY_SHIFT 3 // the bounce estimate loses 1/8 per press or release shorter than it
+#define CALLBACK_TASK_STACK_SIZE 4096
 
 static QueueHandle_t switchDebounceCallbackQueue = nullptr;
 static TaskHandle_t switchDebounceCallbackHandler = nullptr;
 
+// Queue usage, for Container::getResourceStats()
+static volatile u_int16_t callbackQueuePeak = 0;
+static volatile u_int32_t callbackQueueDropped = 0;
+
 void IRAM_ATTR switchDebounce_isr(void *arg)
 {
   if (arg == nullptr)
@@ -15,13 +21,22 @@ void IRAM_ATTR switchDebounce_isr(void *arg)
   }
 
   SwitchDebounce *debounceInstance = (SwitchDebounce *)arg;
-  if (debounceInstance->onSwitchEvent == nullptr)
+  if (debounceInstance->onSwitchEvent == nullptr && debounceInstance->onSwitchEventArg == nullptr)
   {
     return;
   }
 
+  SIMPLEUI_TRACE(TRACE_SWITCH_ISR);
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-  xTimerResetFromISR(debounceInstance->m_debounceTimer, &xHigherPriorityTaskWoken);
+  if (debounceInstance->m_adaptive && debounceInstance->measureEdge(micros(), digitalRead(debounceInstance->m_pin)))
+  {
+    // Changing the period restarts the timer as well.
+    xTimerChangePeriodFromISR(debounceInstance->m_debounceTimer, pdMS_TO_TICKS(debounceInstance->m_windowMs), &xHigherPriorityTaskWoken);
+  }
+  else
+  {
+    xTimerResetFromISR(debounceInstance->m_debounceTimer, &xHigherPriorityTaskWoken);
+  }
   if (xHigherPriorityTaskWoken == pdTRUE)
   {
     portYIELD_FROM_ISR();
@@ -43,7 +58,19 @@ void switchDebounce_timerCallback(TimerHandle_t xTimer)
     return;
   }
   debounceInstance->m_lastPinState = pinState;
-  xQueueSend(switchDebounceCallbackQueue, &debounceInstance, 0);
+  debounceInstance->m_burstDispatches++;
+  if (xQueueSend(switchDebounceCallbackQueue, &debounceInstance, 0) == pdTRUE)
+  {
+    UBaseType_t depth = uxQueueMessagesWaiting(switchDebounceCallbackQueue);
+    if (depth > callbackQueuePeak)
+    {
+      callbackQueuePeak = depth;
+    }
+  }
+  else
+  {
+    callbackQueueDropped++;
+  }
 }
 
 void handleSwitchDebounceCallbackTask(void *param)
@@ -53,22 +80,29 @@ void handleSwitchDebounceCallbackTask(void *param)
     SwitchDebounce *debounceInstance;
     if (xQueueReceive(switchDebounceCallbackQueue, &debounceInstance, portMAX_DELAY))
     {
-      if (debounceInstance->onSwitchEvent != nullptr)
-      {
-        DEBUG_SIMPLEUI("SwitchDebounce Callback: pin %d state %d\n", debounceInstance->m_pin, debounceInstance->m_lastPinState);
-        DEBUG_SIMPLEUI("--------------------------------------------\n");
-        // Call the user-defined callback
-        debounceInstance->onSwitchEvent(debounceInstance->m_lastPinState);
-      }
+      SIMPLEUI_TRACE(TRACE_SWITCH_EVENT, debounceInstance->m_pin, debounceInstance->m_lastPinState);
+      debounceInstance->dispatch();
     }
   }
 }
 
 SwitchDebounce::SwitchDebounce(u_int8_t pin, void (*switchEventResponder)(const u_int8_t pinState))
     : m_pin(pin),
+      m_lastPinState(HIGH),
       m_debounceTimer(nullptr),
-      onSwitchEvent(switchEventResponder)
+      m_windowMs(DEBOUNCE_TIME_MS),
+      m_adaptive(false),
+      m_minMs(SIMPLEUI_SWITCH_DEBOUNCE_MIN_MS),
+      m_maxMs(SIMPLEUI_SWITCH_DEBOUNCE_MAX_MS),
+      m_burstStartUs(0),
+      m_lastEdgeUs(0),
+      m_burstStartLevel(HIGH),
+      m_burstDispatches(0),
+      onSwitchEvent(switchEventResponder),
+      onSwitchEventArg(nullptr),
+      m_callbackArg(nullptr)
 {
+  memset(&m_stats, 0, sizeof(m_stats));
   if (switchDebounceCallbackQueue == nullptr)
   {
     switchDebounceCallbackQueue = xQueueCreate(QUEUE_LENGTH, sizeof(SwitchDebounce *));
@@ -79,13 +113,20 @@ SwitchDebounce::SwitchDebounce(u_int8_t pin, void (*switchEventResponder)(const
     xTaskCreate(
         handleSwitchDebounceCallbackTask, // Function that implements the task.
         "Switch Debounce Callback Task",  // Text name for the task.
-        4096,                             // Stack size in bytes.
+        CALLBACK_TASK_STACK_SIZE,         // Stack size in bytes.
         nullptr,                          // Parameter passed into the task.
         2 | portPRIVILEGE_BIT,            // Priority at which the task is created. (0=lowest)
         &switchDebounceCallbackHandler);  // Used to pass out the created task's handle.
   }
 }
 
+SwitchDebounce::SwitchDebounce(u_int8_t pin, void (*switchEventResponder)(const u_int8_t pinState, void *arg), void *arg)
+    : SwitchDebounce(pin, (void (*)(const u_int8_t))nullptr)
+{
+  onSwitchEventArg = switchEventResponder;
+  m_callbackArg = arg;
+}
+
 SwitchDebounce::~SwitchDebounce()
 {
   detachInterrupt(digitalPinToInterrupt(m_pin));
@@ -98,9 +139,100 @@ SwitchDebounce::~SwitchDebounce()
   }
 }
 
+void SwitchDebounce::dispatch()
+{
+  // Call the user-defined callback
+  if (onSwitchEventArg != nullptr)
+  {
+    onSwitchEventArg(m_lastPinState, m_callbackArg);
+  }
+  else if (onSwitchEvent != nullptr)
+  {
+    onSwitchEvent(m_lastPinState);
+  }
+}
+
+// Called from the ISR for every edge. Returns true if the debounce window changed.
+bool IRAM_ATTR SwitchDebounce::measureEdge(unsigned long nowUs, int level)
+{
+  bool first = m_stats.edges++ == 0;
+  unsigned long quietUs = nowUs - m_lastEdgeUs;
+  // A quick tap: the press was reported and the pin goes back to where the burst started. An edge within
+  // twice the window is still bounce, reported twice because the window was too short.
+  bool returned = m_burstDispatches > 0 && level == m_burstStartLevel && quietUs >= m_windowMs * 2000UL;
+  if (!first && quietUs < m_maxMs * 1000UL && !returned)
+  {
+    m_lastEdgeUs = nowUs; // still bouncing
+    return false;
+  }
+
+  // A new press or release: the previous one is over, its edges give the bounce duration.
+  bool changed = false;
+  if (!first)
+  {
+    u_int32_t bounceUs = m_lastEdgeUs - m_burstStartUs;
+    m_stats.bursts++;
+    m_stats.lastBounceUs = bounceUs;
+    m_stats.maxBounceUs = bounceUs > m_stats.maxBounceUs ? bounceUs : m_stats.maxBounceUs;
+    if (m_burstDispatches > 1)
+    {
+      m_stats.doubleFires++;
+    }
+    u_int32_t decayed = m_stats.estimateUs - (m_stats.estimateUs >> ADAPTIVE_DECAY_SHIFT);
+    m_stats.estimateUs = bounceUs > decayed ? bounceUs : decayed;
+
+    u_int32_t windowMs = (m_stats.estimateUs * 3 / 2 + 999) / 1000;
+    windowMs = windowMs < m_minMs ? m_minMs : windowMs > m_maxMs ? m_maxMs : windowMs;
+    changed = windowMs != m_windowMs;
+    m_windowMs = windowMs;
+    m_stats.windowMs = windowMs;
+  }
+  m_burstStartUs = nowUs;
+  m_lastEdgeUs = nowUs;
+  m_burstStartLevel = m_lastPinState;
+  m_burstDispatches = 0;
+  return changed;
+}
+
+void SwitchDebounce::enableAdaptiveDebounce(u_int16_t minMs, u_int16_t maxMs)
+{
+  m_minMs = minMs > 0 ? minMs : 1;
+  m_maxMs = maxMs > m_minMs ? maxMs : m_minMs;
+  memset(&m_stats, 0, sizeof(m_stats));
+  // Learning starts from the fixed window, so the switch is never less debounced than before.
+  m_windowMs = DEBOUNCE_TIME_MS < m_minMs ? m_minMs : DEBOUNCE_TIME_MS > m_maxMs ? m_maxMs : DEBOUNCE_TIME_MS;
+  m_stats.estimateUs = m_windowMs * 2000UL / 3;
+  m_stats.windowMs = m_windowMs;
+  m_stats.adaptive = true;
+  if (m_debounceTimer != nullptr && xTimerGetPeriod(m_debounceTimer) != pdMS_TO_TICKS(m_windowMs))
+  {
+    xTimerChangePeriod(m_debounceTimer, pdMS_TO_TICKS(m_windowMs), portMAX_DELAY);
+    xTimerStop(m_debounceTimer, portMAX_DELAY); // changing the period starts the timer
+  }
+  m_adaptive = true;
+}
+
+void SwitchDebounce::disableAdaptiveDebounce()
+{
+  m_adaptive = false;
+  m_stats.adaptive = false;
+  m_windowMs = DEBOUNCE_TIME_MS;
+  if (m_debounceTimer != nullptr && xTimerGetPeriod(m_debounceTimer) != pdMS_TO_TICKS(m_windowMs))
+  {
+    xTimerChangePeriod(m_debounceTimer, pdMS_TO_TICKS(m_windowMs), portMAX_DELAY);
+    xTimerStop(m_debounceTimer, portMAX_DELAY);
+  }
+}
+
+void SwitchDebounce::getDebounceStats(SwitchDebounceStats &stats) const
+{
+  stats = m_stats;
+  stats.windowMs = m_windowMs;
+}
+
 void SwitchDebounce::start()
 {
-  DEBUG_SIMPLEUI("SwitchDebounce::start on pin %d\n", m_pin);
+  SIMPLEUI_TRACE(TRACE_SWITCH_START, m_pin);
 
   m_lastPinState = digitalRead(m_pin);
 
@@ -111,7 +243,7 @@ void SwitchDebounce::start()
 
   m_debounceTimer = xTimerCreate(
       "Switch Debounce Timer",
-      pdMS_TO_TICKS(DEBOUNCE_TIME_MS),
+      pdMS_TO_TICKS(m_windowMs),
       pdFALSE, // one-shot timer
       (void *)this,
       switchDebounce_timerCallback);
@@ -122,3 +254,44 @@ void SwitchDebounce::start()
       (void *)this,
       CHANGE);
 }
+
+void SwitchDebounce::getSharedResourceStats(ResourceStats &stats)
+{
+  TaskStats &callbackTask = stats.tasks[RESOURCE_TASK_SWITCH_CALLBACK];
+  callbackTask.name = "Switch CB";
+  callbackTask.stackSize = CALLBACK_TASK_STACK_SIZE;
+  callbackTask.created = switchDebounceCallbackHandler != nullptr;
+  callbackTask.stackHighWaterMark = callbackTask.created ? uxTaskGetStackHighWaterMark(switchDebounceCallbackHandler) : 0;
+
+  QueueStats &callbackQueue = stats.queues[RESOURCE_QUEUE_SWITCH_CALLBACK];
+  callbackQueue.name = "Switch CB Q";
+  callbackQueue.length = QUEUE_LENGTH;
+  callbackQueue.depth = switchDebounceCallbackQueue ? uxQueueMessagesWaiting(switchDebounceCallbackQueue) : 0;
+  callbackQueue.peak = callbackQueuePeak;
+  callbackQueue.dropped = callbackQueueDropped;
+
+  if (callbackTask.created)
+  {
+    stats.sharedHeapBytes += CALLBACK_TASK_STACK_SIZE + sizeof(StaticTask_t);
+  }
+  if (switchDebounceCallbackQueue)
+  {
+    stats.sharedHeapBytes += QUEUE_LENGTH * sizeof(SwitchDebounce *) + sizeof(StaticQueue_t);
+  }
+}
+
+void SwitchDebounce::getResourceStats(ResourceStats &stats) const
+{
+  getSharedResourceStats(stats);
+
+  TimerStats &timer = stats.timers[RESOURCE_TIMER_SWITCH_DEBOUNCE];
+  timer.name = "Switch Tmr";
+  timer.periodMs = m_windowMs;
+  timer.active = m_debounceTimer != nullptr && xTimerIsTimerActive(m_debounceTimer) != pdFALSE;
+
+  stats.heapBytes += sizeof(SwitchDebounce);
+  if (m_debounceTimer)
+  {
+    stats.heapBytes += sizeof(StaticTimer_t);
+  }
+}
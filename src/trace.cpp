@@ -0,0 +1,148 @@
+#include "trace.h"
+
+#ifdef SIMPLEUI_TRACE_ENABLED
+#include <Arduino.h>
+
+#define TRACE_DRAIN_TASK_STACK_SIZE 2048
+#define TRACE_DRAIN_BATCH 8
+#define TRACE_DRAIN_INTERVAL_MS 20
+#define TRACE_FRAME_SYNC_0 0xA5
+#define TRACE_FRAME_SYNC_1 0x5A
+
+static_assert((SIMPLEUI_TRACE_RING_SIZE & (SIMPLEUI_TRACE_RING_SIZE - 1)) == 0, "SIMPLEUI_TRACE_RING_SIZE must be a power of two");
+
+// A slot is readable when its sequence field holds (record sequence + 1). Writers set it to 0 while they fill
+// the slot, so the reader never sees a half-written record; a slot that still holds an older sequence has
+// not been written yet.
+static TraceRecord s_ring[SIMPLEUI_TRACE_RING_SIZE];
+static u_int32_t s_head = 0; // next sequence handed to a writer
+static u_int32_t s_tail = 0; // next sequence to read
+static volatile u_int32_t s_lost = 0;
+static TaskHandle_t s_drainTaskHandle = nullptr;
+static TRACE_OUTPUT s_drainOutput = TRACE_OUTPUT_TEXT;
+
+#define TRACE_FORMAT(id, format) format,
+static const char *const s_formats[] = {SIMPLEUI_TRACE_POINTS(TRACE_FORMAT)};
+#undef TRACE_FORMAT
+
+void IRAM_ATTR traceWrite(u_int16_t id, u_int16_t argCount, u_int32_t arg0, u_int32_t arg1, u_int32_t arg2)
+{
+  u_int32_t sequence = __atomic_fetch_add(&s_head, 1, __ATOMIC_RELAXED);
+  TraceRecord &record = s_ring[sequence & (SIMPLEUI_TRACE_RING_SIZE - 1)];
+
+  __atomic_store_n(&record.sequence, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  record.cycles = ESP.getCycleCount();
+  record.id = id;
+  record.argCount = argCount;
+  record.args[0] = arg0;
+  record.args[1] = arg1;
+  record.args[2] = arg2;
+  __atomic_store_n(&record.sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+size_t traceRead(TraceRecord *records, size_t maxRecords)
+{
+  size_t count = 0;
+  while (count < maxRecords)
+  {
+    u_int32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    if (head == s_tail)
+    {
+      break;
+    }
+    if (head - s_tail > SIMPLEUI_TRACE_RING_SIZE)
+    {
+      // Writers lapped the reader: skip to the oldest record still in the ring.
+      s_lost += head - SIMPLEUI_TRACE_RING_SIZE - s_tail;
+      s_tail = head - SIMPLEUI_TRACE_RING_SIZE;
+    }
+
+    const TraceRecord &slot = s_ring[s_tail & (SIMPLEUI_TRACE_RING_SIZE - 1)];
+    u_int32_t sequence = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+    if (sequence != s_tail + 1)
+    {
+      if (sequence == 0 || sequence - 1 < s_tail)
+      {
+        break; // still being written
+      }
+      continue; // overwritten by a newer record, resynchronise on the next pass
+    }
+
+    TraceRecord &record = records[count];
+    record = slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) != sequence)
+    {
+      s_lost++; // overwritten while copying
+      s_tail++;
+      continue;
+    }
+    record.sequence = s_tail++;
+    count++;
+  }
+  return count;
+}
+
+u_int32_t traceLost()
+{
+  return s_lost;
+}
+
+const char *traceFormat(u_int16_t id)
+{
+  return id < TRACE_ID_COUNT ? s_formats[id] : "unknown trace point";
+}
+
+static void traceDrainTask(void *parameter)
+{
+  TraceRecord records[TRACE_DRAIN_BATCH];
+  u_int32_t reportedLost = 0;
+  for (;;)
+  {
+    size_t count = traceRead(records, TRACE_DRAIN_BATCH);
+    for (size_t i = 0; i < count; i++)
+    {
+      const TraceRecord &record = records[i];
+      if (s_drainOutput == TRACE_OUTPUT_BINARY)
+      {
+        const uint8_t sync[] = {TRACE_FRAME_SYNC_0, TRACE_FRAME_SYNC_1};
+        Serial.write(sync, sizeof(sync));
+        Serial.write((const uint8_t *)&record, sizeof(record));
+        continue;
+      }
+      Serial.printf("[%lu] ", (unsigned long)record.cycles);
+      Serial.printf(traceFormat(record.id), record.args[0], record.args[1], record.args[2]);
+      Serial.printf("\n");
+    }
+
+    u_int32_t lost = s_lost;
+    if (lost != reportedLost && s_drainOutput == TRACE_OUTPUT_TEXT)
+    {
+      Serial.printf("trace: %lu records lost\n", (unsigned long)(lost - reportedLost));
+    }
+    reportedLost = lost; // binary captures show the gap in the sequence numbers
+
+    if (count < TRACE_DRAIN_BATCH)
+    {
+      vTaskDelay(pdMS_TO_TICKS(TRACE_DRAIN_INTERVAL_MS));
+    }
+  }
+}
+
+void traceStartDrainTask(TRACE_OUTPUT output)
+{
+  s_drainOutput = output;
+  if (s_drainTaskHandle == nullptr)
+  {
+    xTaskCreate(
+        traceDrainTask,
+        "Trace Drain Task",
+        TRACE_DRAIN_TASK_STACK_SIZE,
+        nullptr,
+        0 | portPRIVILEGE_BIT, // idle priority: formatting only uses spare time
+        &s_drainTaskHandle);
+  }
+}
+
+#endif // SIMPLEUI_TRACE_ENABLED
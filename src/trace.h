@@ -0,0 +1,80 @@
+#ifndef Futojin_TRACE_H
+#define Futojin_TRACE_H
+
+#include <sys/types.h>
+
+// Binary trace log. SIMPLEUI_TRACE(id, args...) stores a fixed-size record (sequence, cycle count, trace point
+// id, up to 3 integer args) into a lock-free RAM ring, safe from ISRs and any task. Nothing is formatted at
+// the trace point: traceStartDrainTask() prints records from a low-priority task, or streams them raw for
+// tools/trace_decode.py, which reads the format strings from this file.
+//
+// Compiled out unless SIMPLEUI_TRACE_ENABLED is defined. SIMPLEUI_TRACE_RING_SIZE (power of two) sets the
+// number of records kept.
+
+// Trace points: id, format. Arguments are 32-bit integers, so only %d, %u and %x conversions are allowed.
+// Append new points at the end, the decoder and old captures rely on the numbering.
+#define SIMPLEUI_TRACE_POINTS(X)                                     \
+  X(TRACE_ROTARY_ISR, "rotary isr")                                  \
+  X(TRACE_ROTARY_EDGE, "rotary edge A=%d B=%d phase=%d")             \
+  X(TRACE_ROTARY_TIMEOUT, "rotary timeout after %u ms")              \
+  X(TRACE_ROTARY_PHASE, "rotary phase=%d direction=%d")              \
+  X(TRACE_ROTARY_EVENT, "rotary event %d")                           \
+  X(TRACE_ROTARY_START, "rotary start A=%d B=%d")                    \
+  X(TRACE_SWITCH_ISR, "switch isr")                                  \
+  X(TRACE_SWITCH_EVENT, "switch pin=%d state=%d")                    \
+  X(TRACE_SWITCH_START, "switch start pin=%d")                       \
+  X(TRACE_CONTAINER_EVENT, "event id=%d value=%u context=%d")        \
+  X(TRACE_CONTAINER_WAKE, "woke from screen saver, event ignored")   \
+  X(TRACE_CONTAINER_YIELD, "yield from %d") /* no longer emitted */  \
+  X(TRACE_CONTAINER_PAGE, "page %u")                                 \
+  X(TRACE_DRAW, "draw requests=0x%x")                                \
+  X(TRACE_FLUSH, "flush bytes=%u transactions=%u time=%u us")        \
+  X(TRACE_TRANSITION, "transition kind=%d step=%u dropped=%u")       \
+  X(TRACE_NAVIGATION, "navigation context=%d input=%d next=%d")
+
+#define SIMPLEUI_TRACE_ENUM(id, format) id,
+enum TRACE_ID
+{
+  SIMPLEUI_TRACE_POINTS(SIMPLEUI_TRACE_ENUM)
+  TRACE_ID_COUNT
+};
+#undef SIMPLEUI_TRACE_ENUM
+
+#ifndef SIMPLEUI_TRACE_RING_SIZE
+#define SIMPLEUI_TRACE_RING_SIZE 64
+#endif
+
+struct TraceRecord
+{
+  u_int32_t sequence; // position in the trace, increases by one per record
+  u_int32_t cycles;   // CPU cycle counter at the trace point
+  u_int16_t id;       // TRACE_ID
+  u_int16_t argCount;
+  u_int32_t args[3];
+};
+
+enum TRACE_OUTPUT
+{
+  TRACE_OUTPUT_TEXT,  // formatted lines on Serial
+  TRACE_OUTPUT_BINARY // framed records on Serial, for tools/trace_decode.py
+};
+
+#ifdef SIMPLEUI_TRACE_ENABLED
+
+void traceWrite(u_int16_t id, u_int16_t argCount, u_int32_t arg0, u_int32_t arg1, u_int32_t arg2);
+size_t traceRead(TraceRecord *records, size_t maxRecords); // single consumer
+u_int32_t traceLost();                                      // records overwritten before they were read
+const char *traceFormat(u_int16_t id);
+void traceStartDrainTask(TRACE_OUTPUT output = TRACE_OUTPUT_TEXT);
+
+inline void simpleUITrace(u_int16_t id) { traceWrite(id, 0, 0, 0, 0); }
+inline void simpleUITrace(u_int16_t id, u_int32_t a) { traceWrite(id, 1, a, 0, 0); }
+inline void simpleUITrace(u_int16_t id, u_int32_t a, u_int32_t b) { traceWrite(id, 2, a, b, 0); }
+inline void simpleUITrace(u_int16_t id, u_int32_t a, u_int32_t b, u_int32_t c) { traceWrite(id, 3, a, b, c); }
+#define SIMPLEUI_TRACE(...) simpleUITrace(__VA_ARGS__)
+
+#else
+#define SIMPLEUI_TRACE(...)
+#endif
+
+#endif // Futojin_TRACE_H
@@ -0,0 +1,239 @@
+#include "transition.h"
+#include <string.h>
+
+#define TRANSITION_MAX_HEIGHT 64 // one column of the panel fits in a uint64_t
+#define TRANSITION_ONE 1024      // fixed-point 1.0 for progress
+
+// Bit y of the result is bit y + offset of value: a positive offset moves the content up.
+static inline uint64_t shiftRows(uint64_t value, int16_t offset)
+{
+  if (offset >= TRANSITION_MAX_HEIGHT || offset <= -TRANSITION_MAX_HEIGHT)
+  {
+    return 0;
+  }
+  return offset >= 0 ? value >> offset : value << -offset;
+}
+
+static inline int16_t interpolate(int16_t from, int16_t to, u_int32_t progress)
+{
+  return from + (int32_t)(to - from) * (int32_t)progress / TRANSITION_ONE;
+}
+
+FrameTransition::FrameTransition()
+    : m_from(nullptr),
+      m_to(nullptr),
+      m_size(0),
+      m_width(0),
+      m_height(0),
+      m_interrupted(false),
+      m_startMs(0),
+      m_durationMs(0),
+      m_frames(0),
+      m_dropped(0),
+      m_active(false)
+{
+  memset(&m_hint, 0, sizeof(m_hint));
+  memset(&m_drawnHighlight, 0, sizeof(m_drawnHighlight));
+}
+
+FrameTransition::~FrameTransition()
+{
+  delete[] m_from;
+  delete[] m_to;
+}
+
+bool FrameTransition::capture(const uint8_t *buffer, u_int16_t width, u_int16_t height)
+{
+  if (height > TRANSITION_MAX_HEIGHT || height % 8 != 0)
+  {
+    return false;
+  }
+  size_t size = (size_t)width * height / 8;
+  if (size != m_size)
+  {
+    // Allocated on the first transition, so containers that never animate keep the RAM.
+    delete[] m_from;
+    delete[] m_to;
+    m_from = new uint8_t[size];
+    m_to = new uint8_t[size];
+    m_size = size;
+  }
+  m_width = width;
+  m_height = height;
+  memcpy(m_from, buffer, m_size);
+  m_interrupted = m_active && m_hint.highlight;
+  m_active = false;
+  return true;
+}
+
+void FrameTransition::begin(const TransitionHint &hint, const uint8_t *buffer, unsigned long nowMs, u_int16_t durationMs)
+{
+  memcpy(m_to, buffer, m_size);
+  m_hint = hint;
+  if (m_hint.highlight && m_interrupted)
+  {
+    m_hint.fromHighlight = m_drawnHighlight; // continue from where the highlight is on screen
+  }
+  if (m_hint.highlight)
+  {
+    // Highlights are drawn per step, so neither capture may carry its own.
+    outline(m_from, m_hint.fromHighlight, false);
+    outline(m_to, m_hint.toHighlight, false);
+  }
+  m_startMs = nowMs;
+  m_durationMs = durationMs;
+  m_frames = 0;
+  m_dropped = 0;
+  m_active = true;
+}
+
+void FrameTransition::exclude(const TransitionRect &rect)
+{
+  uint64_t mask = rowMask(rect.y, rect.h);
+  for (int16_t x = rect.x < 0 ? 0 : rect.x; x < rect.x + rect.w && x < m_width; x++)
+  {
+    setColumn(m_from, x, 0, mask);
+    setColumn(m_to, x, 0, mask);
+  }
+}
+
+bool FrameTransition::step(uint8_t *buffer, unsigned long nowMs)
+{
+  if (!m_active)
+  {
+    return false;
+  }
+
+  u_int32_t elapsed = nowMs - m_startMs;
+  u_int32_t due = elapsed / SIMPLEUI_TRANSITION_FRAME_MS + 1;
+  u_int32_t total = (m_durationMs + SIMPLEUI_TRANSITION_FRAME_MS - 1) / SIMPLEUI_TRANSITION_FRAME_MS;
+  due = due < total ? due : total;
+  m_frames++;
+  if (due > m_frames + m_dropped)
+  {
+    m_dropped = due - m_frames;
+  }
+
+  // Each step shows the transition as it should look when its flush completes, one budget from now.
+  elapsed += SIMPLEUI_TRANSITION_FRAME_MS;
+  memcpy(buffer, m_to, m_size);
+  if (elapsed >= m_durationMs)
+  {
+    if (m_hint.highlight)
+    {
+      outline(buffer, m_hint.toHighlight, true);
+      m_drawnHighlight = m_hint.toHighlight;
+    }
+    m_active = false;
+    return false;
+  }
+
+  // Ease out: fast start, so the first step already shows the direction of the move.
+  u_int32_t linear = elapsed * TRANSITION_ONE / m_durationMs;
+  u_int32_t progress = TRANSITION_ONE - (TRANSITION_ONE - linear) * (TRANSITION_ONE - linear) / TRANSITION_ONE;
+  if (m_hint.kind == TRANSITION_SLIDE || m_hint.kind == TRANSITION_SCROLL)
+  {
+    composeRegion(buffer, interpolate(0, m_hint.distance, progress));
+  }
+  if (m_hint.highlight)
+  {
+    const TransitionRect &from = m_hint.fromHighlight;
+    const TransitionRect &to = m_hint.toHighlight;
+    TransitionRect rect = {interpolate(from.x, to.x, progress), interpolate(from.y, to.y, progress),
+                           interpolate(from.w, to.w, progress), interpolate(from.h, to.h, progress)};
+    outline(buffer, rect, true);
+    m_drawnHighlight = rect;
+  }
+  return true;
+}
+
+u_int32_t FrameTransition::nextStepMs(unsigned long nowMs) const
+{
+  u_int32_t dueMs = (u_int32_t)(m_frames + m_dropped) * SIMPLEUI_TRANSITION_FRAME_MS;
+  u_int32_t elapsed = nowMs - m_startMs;
+  return elapsed >= dueMs ? 0 : dueMs - elapsed;
+}
+
+// Only the columns of the region are touched. Window position p shows source position p + offset: the
+// previous frame while that is still inside the region, the next frame, placed distance further on, beyond it.
+void FrameTransition::composeRegion(uint8_t *buffer, int16_t offset) const
+{
+  const TransitionRect &region = m_hint.region;
+  int16_t distance = m_hint.distance;
+  int16_t right = region.x + region.w;
+  uint64_t mask = rowMask(region.y, region.h);
+  uint64_t inside = shiftRows(mask, offset);
+
+  for (int16_t x = region.x < 0 ? 0 : region.x; x < right && x < m_width; x++)
+  {
+    uint64_t bits = 0;
+    if (m_hint.kind == TRANSITION_SLIDE)
+    {
+      int16_t source = x + offset;
+      if (source >= region.x && source < right)
+      {
+        bits = column(m_from, source);
+      }
+      else if (source - distance >= 0 && source - distance < m_width)
+      {
+        bits = column(m_to, source - distance);
+      }
+    }
+    else
+    {
+      bits = (shiftRows(column(m_from, x), offset) & inside) | (shiftRows(column(m_to, x), offset - distance) & ~inside);
+    }
+    setColumn(buffer, x, bits, mask);
+  }
+}
+
+uint64_t FrameTransition::column(const uint8_t *frame, int16_t x) const
+{
+  uint64_t bits = 0;
+  for (u_int16_t page = 0; page < m_height / 8; page++)
+  {
+    bits |= (uint64_t)frame[x + page * m_width] << (page * 8);
+  }
+  return bits;
+}
+
+void FrameTransition::setColumn(uint8_t *frame, int16_t x, uint64_t bits, uint64_t mask) const
+{
+  for (u_int16_t page = 0; page < m_height / 8; page++)
+  {
+    uint8_t pageMask = mask >> (page * 8);
+    if (pageMask)
+    {
+      uint8_t &byte = frame[x + page * m_width];
+      byte = (byte & ~pageMask) | ((bits >> (page * 8)) & pageMask);
+    }
+  }
+}
+
+uint64_t FrameTransition::rowMask(int16_t y, int16_t h) const
+{
+  int16_t top = y < 0 ? 0 : y;
+  int16_t bottom = y + h > m_height ? m_height : y + h;
+  if (bottom <= top)
+  {
+    return 0;
+  }
+  uint64_t below = bottom >= TRANSITION_MAX_HEIGHT ? UINT64_MAX : (1ULL << bottom) - 1;
+  return below & ~((1ULL << top) - 1);
+}
+
+// Same pixels as OLEDDisplay::drawRect().
+void FrameTransition::outline(uint8_t *frame, const TransitionRect &rect, bool set) const
+{
+  if (rect.w <= 0 || rect.h <= 0)
+  {
+    return;
+  }
+  uint64_t edges = rowMask(rect.y, 1) | rowMask(rect.y + rect.h - 1, 1);
+  uint64_t sides = rowMask(rect.y, rect.h);
+  for (int16_t x = rect.x < 0 ? 0 : rect.x; x < rect.x + rect.w && x < m_width; x++)
+  {
+    uint64_t mask = (x == rect.x || x == rect.x + rect.w - 1) ? sides : edges;
+    setColumn(frame, x, set ? UINT64_MAX : 0, mask);
+  }
+}
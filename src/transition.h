@@ -0,0 +1,99 @@
+#ifndef Futojin_TRANSITION_H
+#define Futojin_TRANSITION_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+// Animated transitions between two frames. Nothing is redrawn per step: the frame on screen and the next
+// frame are captured once, and every step composes the moving region from the two captures, then outlines
+// the highlight at its interpolated position. Progress is taken from the clock, so a step that runs late
+// skips ahead instead of slowing the transition down, and the last step always shows the exact next frame
+// SIMPLEUI_TRANSITION_MS after it started.
+//
+// Frame buffers use the SH1106 page layout (x + (y / 8) * width) and panels up to 64 rows high.
+
+#ifndef SIMPLEUI_TRANSITION_MS
+#define SIMPLEUI_TRANSITION_MS 160
+#endif
+#ifndef SIMPLEUI_TRANSITION_FRAME_MS
+#define SIMPLEUI_TRANSITION_FRAME_MS 20 // time budget per step, including the flush
+#endif
+
+enum TRANSITION_KIND
+{
+  TRANSITION_NONE,   // no frame pending
+  TRANSITION_CUT,    // the next frame replaces the current one at once
+  TRANSITION_SLIDE,  // region content moves sideways by distance, the new content follows it in
+  TRANSITION_SCROLL, // region content moves vertically by distance, the new content follows it in
+  TRANSITION_MOVE    // only the highlight moves
+};
+
+struct TransitionRect
+{
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+// What moves between the frame on screen and the next one.
+struct TransitionHint
+{
+  u_int8_t kind;            // TRANSITION_KIND
+  int16_t distance;         // SLIDE: positive moves left. SCROLL: positive moves up
+  TransitionRect region;    // SLIDE and SCROLL
+  bool highlight;           // a highlight outline moves from fromHighlight to toHighlight
+  TransitionRect fromHighlight;
+  TransitionRect toHighlight;
+};
+
+class FrameTransition
+{
+public:
+  FrameTransition();
+  ~FrameTransition();
+  FrameTransition(const FrameTransition &) = delete;
+  FrameTransition &operator=(const FrameTransition &) = delete;
+
+  // Copies the frame on screen and ends a running transition. Call before the next frame is drawn into the
+  // same buffer.
+  bool capture(const uint8_t *buffer, u_int16_t width, u_int16_t height);
+  // Copies the next frame and starts the transition.
+  void begin(const TransitionHint &hint, const uint8_t *buffer, unsigned long nowMs, u_int16_t durationMs);
+  // Clears a rectangle in both captures, for content drawn on top of every step.
+  void exclude(const TransitionRect &rect);
+  // Composes the frame at nowMs into buffer. Returns false once the next frame is complete.
+  bool step(uint8_t *buffer, unsigned long nowMs);
+  void cancel() { m_active = false; }
+
+  bool active() const { return m_active; }
+  u_int8_t kind() const { return m_hint.kind; }
+  // Milliseconds until the next step is due, 0 if it is late.
+  u_int32_t nextStepMs(unsigned long nowMs) const;
+  u_int16_t frames() const { return m_frames; }
+  u_int16_t droppedFrames() const { return m_dropped; }
+  size_t heapUsage() const { return m_size * 2; }
+
+private:
+  uint8_t *m_from;
+  uint8_t *m_to;
+  size_t m_size;
+  u_int16_t m_width;
+  u_int16_t m_height;
+  TransitionHint m_hint;
+  TransitionRect m_drawnHighlight; // highlight of the last step, where an interrupted transition left it
+  bool m_interrupted;              // the captured frame is a step of an unfinished transition
+  unsigned long m_startMs;
+  u_int16_t m_durationMs;
+  u_int16_t m_frames;  // steps composed
+  u_int16_t m_dropped; // steps skipped because a previous one ran over its budget
+  bool m_active;
+
+  uint64_t column(const uint8_t *frame, int16_t x) const;
+  void setColumn(uint8_t *frame, int16_t x, uint64_t bits, uint64_t mask) const;
+  uint64_t rowMask(int16_t y, int16_t h) const;
+  void outline(uint8_t *frame, const TransitionRect &rect, bool set) const;
+  void composeRegion(uint8_t *buffer, int16_t offset) const;
+};
+
+#endif // Futojin_TRANSITION_H
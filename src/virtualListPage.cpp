@@ -0,0 +1,181 @@
+#include "simpleUI.h"
+#include "itemRenderer.h"
+
+VirtualListPage::VirtualListPage(const unsigned char *icon, ListDataSource &source, u_int8_t cacheRows)
+    : Page(icon),
+      m_source(&source),
+      m_cache(nullptr),
+      m_cacheRows(cacheRows),
+      m_currentRow(0)
+{
+  if (m_cacheRows > 0)
+  {
+    m_cache = new CachedRow[m_cacheRows];
+    invalidate();
+  }
+}
+
+VirtualListPage::~VirtualListPage()
+{
+  delete[] m_cache;
+}
+
+void VirtualListPage::invalidate()
+{
+  for (u_int8_t i = 0; i < m_cacheRows; i++)
+  {
+    m_cache[i].valid = false;
+  }
+}
+
+void VirtualListPage::invalidate(size_t row)
+{
+  if (m_cacheRows > 0 && m_cache[row % m_cacheRows].row == row)
+  {
+    m_cache[row % m_cacheRows].valid = false;
+  }
+}
+
+const VirtualListPage::CachedRow *VirtualListPage::fetchRow(size_t row)
+{
+  // Direct-mapped: consecutive rows never evict each other as long as the cache holds a screen.
+  CachedRow &entry = m_cache[row % m_cacheRows];
+  if (!entry.valid || entry.row != row)
+  {
+    DEBUG_SIMPLEUI("VirtualListPage::fetchRow: %u\n", (unsigned)row);
+    const char *label = m_source->label(row);
+    strncpy(entry.label, label ? label : "", sizeof(entry.label) - 1);
+    entry.label[sizeof(entry.label) - 1] = '\0';
+    const char *value = m_source->value(row);
+    strncpy(entry.value, value ? value : "", sizeof(entry.value) - 1);
+    entry.value[sizeof(entry.value) - 1] = '\0';
+    entry.row = row;
+    entry.valid = true;
+  }
+  return &entry;
+}
+
+void VirtualListPage::drawRow(size_t row, u_int16_t drawIdx)
+{
+  const char *label;
+  const char *value;
+  if (m_cacheRows > 0)
+  {
+    const CachedRow *entry = fetchRow(row);
+    label = entry->label;
+    value = entry->value;
+    PageItemRenderer::draw(m_display, drawIdx, label, value);
+  }
+  else
+  {
+    // No cache: use each string before the next call into the data source invalidates it.
+    label = m_source->label(row);
+    m_display->setFont(font_item_label);
+    m_display->setTextAlignment(TEXT_ALIGN_LEFT);
+    m_display->drawString(PAGE_ITEM_DRAW_X_MARGIN, drawIdx * PAGE_ITEM_DRAW_HEIGHT, label ? label : "");
+    value = m_source->value(row);
+    m_display->setFont(font_item_value);
+    m_display->setTextAlignment(TEXT_ALIGN_RIGHT);
+    m_display->drawString(m_display->getWidth() - PAGE_ITEM_DRAW_X_MARGIN, drawIdx * PAGE_ITEM_DRAW_HEIGHT, value ? value : "");
+  }
+
+  if (row == m_currentRow)
+  {
+    if (m_context == PAGE)
+    {
+      PageItemRenderer::drawHighlight(m_display, drawIdx);
+    }
+    else if (m_context == ITEM)
+    {
+      PageItemRenderer::drawValueHighlight(m_display, drawIdx, value ? value : "");
+    }
+  }
+}
+
+// Keep the current row in the middle of the screen, if possible.
+size_t VirtualListPage::firstVisibleRow() const
+{
+  return m_currentRow > (LIST_PAGE_DRAW_SIZE / 2) ? m_currentRow - (LIST_PAGE_DRAW_SIZE / 2) : 0;
+}
+
+void VirtualListPage::drawItems()
+{
+  size_t count = m_source->count();
+  if (count == 0)
+  {
+    return; // Nothing to draw
+  }
+  if (m_currentRow >= count)
+  {
+    m_currentRow = count - 1; // Data source shrank
+  }
+  DEBUG_SIMPLEUI("VirtualListPage::drawItems\n");
+
+  size_t firstRow = firstVisibleRow();
+  for (u_int16_t drawIdx = 0; drawIdx < LIST_PAGE_DRAW_SIZE && firstRow + drawIdx < count; drawIdx++)
+  {
+    drawRow(firstRow + drawIdx, drawIdx);
+  }
+}
+
+void VirtualListPage::start()
+{
+  invalidate(); // re-get values
+}
+
+void VirtualListPage::reset()
+{
+  m_currentRow = 0;
+}
+
+bool VirtualListPage::restoreCursor(u_int32_t cursor)
+{
+  if (cursor != 0 && cursor >= m_source->count())
+  {
+    return false;
+  }
+  m_currentRow = cursor;
+  return true;
+}
+
+bool VirtualListPage::moveSelection(int8_t step)
+{
+  if (step > 0 && m_currentRow + 1 < m_source->count())
+  {
+    m_currentRow++;
+  }
+  else if (step < 0 && m_currentRow > 0)
+  {
+    m_currentRow--;
+  }
+  else
+  {
+    return false;
+  }
+  DEBUG_SIMPLEUI("VirtualListPage::moveSelection: row: %u\n", (unsigned)m_currentRow);
+  return true;
+}
+
+void VirtualListPage::onItemInput(Event &event)
+{
+  m_source->onRowEvent(m_currentRow, &event);
+  invalidate(m_currentRow);
+}
+
+bool VirtualListPage::selection(PageSelection &selection) const
+{
+  if (m_context != PAGE || m_currentRow >= m_source->count())
+  {
+    return false;
+  }
+  size_t firstRow = firstVisibleRow();
+  selection.viewport = PageItemRenderer::viewport(m_display);
+  selection.scrollY = firstRow * PAGE_ITEM_DRAW_HEIGHT;
+  selection.highlight = PageItemRenderer::highlightRect(m_display, m_currentRow - firstRow);
+  return true;
+}
+
+size_t VirtualListPage::heapUsage() const
+{
+  return m_cacheRows * sizeof(CachedRow);
+}
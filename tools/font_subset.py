@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Generates subset font tables for simpleUI's text roles (see src/fonts.h).
+
+Usage:
+  font_subset.py <OLEDDisplayFonts.h> --role HERO_VALUE=ArialMT_Plain_24:"0123456789.-%" \\
+                 [--role ITEM_VALUE=ArialMT_Plain_10:"0123456789 .%onf"] [--compact] > include/simpleUIFontSubset.h
+
+and build with -DSIMPLEUI_FONT_SUBSET='"simpleUIFontSubset.h"'. Roles: ITEM_LABEL, ITEM_VALUE, HERO_LABEL,
+HERO_VALUE, PERF_OVERLAY. Roles left out keep the full font.
+
+The output is a ThingPulse font: header, one 4-byte jump table entry per character code, then the glyph
+bitmaps. Only glyphs in the role's set keep their bitmap and width; every other entry becomes 0xFFFF (not
+drawable) with width 0. The jump table keeps the source font's character range by default, so glyph lookup
+stays a direct index and characters outside the set are harmless. --compact trims the range to the
+set's lowest and highest characters, saving 4 bytes per code, but the display library does not bounds-check
+getStringWidth(), so strings must then never contain characters outside that range.
+"""
+
+import argparse
+import re
+import shlex
+import sys
+
+ROLES = ("ITEM_LABEL", "ITEM_VALUE", "HERO_LABEL", "HERO_VALUE", "PERF_OVERLAY")
+HEADER_BYTES = 4
+JUMP_BYTES = 4
+
+
+def load_font(path, name):
+    with open(path) as source:
+        text = source.read()
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+    match = re.search(r"\b%s\s*\[\s*\]\s*PROGMEM\s*=\s*\{(.*?)\}\s*;" % re.escape(name), text, re.S)
+    if not match:
+        sys.exit("font %s not found in %s" % (name, path))
+    return [int(value, 0) for value in re.findall(r"0[xX][0-9a-fA-F]+|\d+", match.group(1))]
+
+
+def subset(font, glyphs, compact):
+    width, height, first, count = font[:HEADER_BYTES]
+    jump = font[HEADER_BYTES:HEADER_BYTES + count * JUMP_BYTES]
+    bitmaps = font[HEADER_BYTES + count * JUMP_BYTES:]
+
+    codes = sorted(set(ord(c) for c in glyphs))
+    missing = [c for c in codes if not first <= c < first + count]
+    if missing:
+        sys.exit("characters %r are not in the source font" % "".join(chr(c) for c in missing))
+
+    out_first, out_count = first, count
+    if compact:
+        out_first, out_count = codes[0], codes[-1] - codes[0] + 1
+
+    out_jump = []
+    out_bitmaps = []
+    for code in range(out_first, out_first + out_count):
+        msb, lsb, size, char_width = jump[(code - first) * JUMP_BYTES:(code - first + 1) * JUMP_BYTES]
+        if code not in codes:
+            out_jump += [0xFF, 0xFF, 0, 0]
+        elif msb == 0xFF and lsb == 0xFF:
+            out_jump += [0xFF, 0xFF, 0, char_width]  # blank glyph such as space: width only
+        else:
+            offset = len(out_bitmaps)
+            start = (msb << 8) | lsb
+            out_bitmaps += bitmaps[start:start + size]
+            out_jump += [offset >> 8, offset & 0xFF, size, char_width]
+    return [width, height, out_first, out_count & 0xFF] + out_jump + out_bitmaps
+
+
+def c_array(name, data, comment):
+    lines = ["// %s" % comment, "const uint8_t %s[] PROGMEM = {" % name]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("fonts", help="header with the source fonts, usually the display library's OLEDDisplayFonts.h")
+    parser.add_argument("--role", action="append", required=True, metavar="ROLE=FONT:GLYPHS")
+    parser.add_argument("--compact", action="store_true", help="trim the jump table to the glyph set's range")
+    args = parser.parse_args()
+
+    tables = {}  # (font, glyphs) -> array name, so roles with the same set share one table
+    arrays = []
+    defines = []
+    for spec in args.role:
+        role, _, rest = spec.partition("=")
+        font_name, _, glyphs = rest.partition(":")
+        role = role.upper()
+        if role not in ROLES or not font_name or not glyphs:
+            sys.exit("bad --role %r, expected one of %s as ROLE=FONT:GLYPHS" % (spec, ", ".join(ROLES)))
+
+        key = (font_name, "".join(sorted(set(glyphs))))
+        if key not in tables:
+            font = load_font(args.fonts, font_name)
+            data = subset(font, glyphs, args.compact)
+            name = "font_subset_%d" % len(tables)
+            tables[key] = name
+            comment = '%s subset "%s": %d bytes, full font %d bytes' % (font_name, key[1], len(data), len(font))
+            arrays.append(c_array(name, data, comment))
+        defines.append("#define SIMPLEUI_FONT_%s %s" % (role, tables[key]))
+
+    print("// Generated by tools/font_subset.py. Do not edit.")
+    print("//   %s" % " ".join(shlex.quote(arg) for arg in sys.argv[1:]))
+    print("#ifndef Futojin_FONT_SUBSET_H")
+    print("#define Futojin_FONT_SUBSET_H")
+    print()
+    print("\n\n".join(arrays))
+    print()
+    print("\n".join(defines))
+    print()
+    print("#endif // Futojin_FONT_SUBSET_H")
+
+
+if __name__ == "__main__":
+    main()
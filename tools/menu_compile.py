@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""Compiles a text menu description into a binary menu descriptor (src/menuDescriptor.h).
+
+Usage:
+  menu_compile.py menu.txt -o menu.bin             # for a flash partition
+  menu_compile.py menu.txt --c-array menuData -o menu_data.h
+  menu_compile.py --dump menu.bin                  # lists the content of a descriptor
+
+Description format, one statement per line, '#' starts a comment:
+
+  icon fan fan.xbm                  custom 19x19 icon from an XBM file
+  page settings save                page with a built-in or custom icon; 'save' adds save actions
+    int  "Volume" 0 30 step=1 initial=10 key=volume callback=0
+    bool "Backlight" initial=1 key=backlight
+    enum "Mode" Eco|Normal|Boost initial=1 wrap callback=1
+    int  "Uptime" 0 99999 readonly
+
+Items belong to the page above them. Flags: 'wrap' continues at the other end of the range, 'readonly'
+items are only set by the application. key= binds the value to a settings key (15 characters at most),
+callback= is an index in the firmware's callback table.
+"""
+
+import argparse
+import binascii
+import os
+import re
+import shlex
+import struct
+import sys
+
+MAGIC = 0x444D5553
+VERSION = (1 << 8) | 0
+HEADER = struct.Struct("<IHHIHHHBBIIIII")
+PAGE = struct.Struct("<HHHBB")
+ITEM = struct.Struct("<HHHHBBHiiii")
+ICON_SIZE = 19
+ICON_BYTES = (ICON_SIZE + 7) // 8 * ICON_SIZE
+ICON_CUSTOM = 0x100
+NO_STRING = 0xFFFF
+NO_CALLBACK = 0xFFFF
+KEY_LENGTH = 15
+
+# Same order as s_menuIcons in menuDescriptor.cpp.
+BUILTIN_ICONS = ["settings", "bluetooth", "cancel", "save", "check", "home", "back", "bulb", "power"]
+PAGE_FLAGS = {"save": 0x01}
+ITEM_TYPES = {"int": 0, "bool": 1, "enum": 2}
+ITEM_FLAGS = {"wrap": 0x01, "readonly": 0x02}
+INT32 = (-(1 << 31), (1 << 31) - 1)
+
+
+class DescriptionError(Exception):
+    pass
+
+
+def read_xbm(path):
+    with open(path) as image:
+        text = image.read()
+    sizes = dict((m.group(1), int(m.group(2))) for m in re.finditer(r"#define\s+\w*_(width|height)\s+(\d+)", text))
+    if sizes.get("width") != ICON_SIZE or sizes.get("height") != ICON_SIZE:
+        raise DescriptionError("%s: icons are %dx%d" % (path, ICON_SIZE, ICON_SIZE))
+    data = bytes(int(value, 16) for value in re.findall(r"0x([0-9a-fA-F]{1,2})", text[text.index("{"):]))
+    if len(data) != ICON_BYTES:
+        raise DescriptionError("%s: %d bytes of image data, expected %d" % (path, len(data), ICON_BYTES))
+    return data
+
+
+def parse_item(words, line):
+    kind = words[0]
+    if len(words) < 2:
+        raise DescriptionError("line %d: item without a label" % line)
+    item = {"type": ITEM_TYPES[kind], "label": words[1], "flags": 0, "key": None, "callback": NO_CALLBACK,
+            "options": None, "step": 1}
+    positional = []
+    for word in words[2:]:
+        if word in ITEM_FLAGS:
+            item["flags"] |= ITEM_FLAGS[word]
+        elif "=" in word:
+            name, value = word.split("=", 1)
+            if name == "key":
+                if not 0 < len(value) <= KEY_LENGTH:
+                    raise DescriptionError("line %d: keys have 1 to %d characters" % (line, KEY_LENGTH))
+                item["key"] = value
+            elif name in ("step", "initial", "callback"):
+                item[name] = int(value, 0)
+            else:
+                raise DescriptionError("line %d: unknown attribute %s" % (line, name))
+        else:
+            positional.append(word)
+
+    if kind == "int":
+        if len(positional) != 2:
+            raise DescriptionError("line %d: int items take a minimum and a maximum" % line)
+        item["min"], item["max"] = int(positional[0], 0), int(positional[1], 0)
+    elif kind == "bool":
+        if positional:
+            raise DescriptionError("line %d: bool items take no range" % line)
+        item["min"], item["max"] = 0, 1
+    else:
+        if len(positional) != 1:
+            raise DescriptionError("line %d: enum items take their options as A|B|C" % line)
+        item["options"] = positional[0].split("|")
+        item["min"], item["max"] = 0, len(item["options"]) - 1
+    item.setdefault("initial", item["min"])
+    if not INT32[0] <= item["min"] <= item["max"] <= INT32[1]:
+        raise DescriptionError("line %d: empty or out of range" % line)
+    if not item["min"] <= item["initial"] <= item["max"]:
+        raise DescriptionError("line %d: initial value outside the range" % line)
+    if item["step"] <= 0:
+        raise DescriptionError("line %d: step must be positive" % line)
+    return item
+
+
+def parse(path):
+    icons = []
+    icon_ids = dict((name, index) for index, name in enumerate(BUILTIN_ICONS))
+    pages = []
+    base = os.path.dirname(os.path.abspath(path))
+    with open(path) as source:
+        for number, text in enumerate(source, 1):
+            words = shlex.split(text, comments=True)
+            if not words:
+                continue
+            try:
+                if words[0] == "icon" and len(words) == 3:
+                    if words[1] in icon_ids:
+                        raise DescriptionError("line %d: icon %s already defined" % (number, words[1]))
+                    icon_ids[words[1]] = ICON_CUSTOM + len(icons)
+                    icons.append(read_xbm(os.path.join(base, words[2])))
+                elif words[0] == "page" and len(words) >= 2:
+                    if words[1] not in icon_ids:
+                        raise DescriptionError("line %d: unknown icon %s" % (number, words[1]))
+                    flags = 0
+                    for word in words[2:]:
+                        if word not in PAGE_FLAGS:
+                            raise DescriptionError("line %d: unknown page flag %s" % (number, word))
+                        flags |= PAGE_FLAGS[word]
+                    pages.append({"icon": icon_ids[words[1]], "flags": flags, "items": []})
+                elif words[0] in ITEM_TYPES:
+                    if not pages:
+                        raise DescriptionError("line %d: item before the first page" % number)
+                    pages[-1]["items"].append(parse_item(words, number))
+                else:
+                    raise DescriptionError("line %d: cannot parse '%s'" % (number, text.strip()))
+            except ValueError as error:
+                raise DescriptionError("line %d: %s" % (number, error))
+    return pages, icons
+
+
+class Strings:
+    """String table; identical strings, and identical option lists, are stored once."""
+
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, *strings):
+        blob = b"".join(s.encode("utf-8") + b"\0" for s in strings)
+        if blob not in self.offsets:
+            self.offsets[blob] = len(self.data)
+            self.data += blob
+        if self.offsets[blob] >= NO_STRING:
+            raise DescriptionError("string table larger than 64 KiB")
+        return self.offsets[blob]
+
+
+def align(data):
+    data += bytes(-len(data) % 4)
+
+
+def build(pages, icons):
+    strings = Strings()
+    page_table = bytearray()
+    item_table = bytearray()
+    first = 0
+    for page in pages:
+        page_table += PAGE.pack(page["icon"], first, len(page["items"]), 0, page["flags"])
+        for item in page["items"]:
+            item_table += ITEM.pack(
+                strings.add(item["label"]),
+                strings.add(item["key"]) if item["key"] else NO_STRING,
+                strings.add(*item["options"]) if item["options"] else NO_STRING,
+                item["callback"], item["type"], item["flags"], 0,
+                item["min"], item["max"], item["step"], item["initial"])
+        first += len(page["items"])
+    align(page_table)
+
+    pages_offset = HEADER.size
+    items_offset = pages_offset + len(page_table)
+    icons_offset = items_offset + len(item_table)
+    strings_offset = icons_offset + len(icons) * ICON_BYTES
+    body = bytearray(page_table + item_table + b"".join(icons) + strings.data)
+    size = HEADER.size + len(body) + (-len(body) % 4) + 4
+    header = HEADER.pack(MAGIC, VERSION, HEADER.size, size, len(pages), first, len(icons), PAGE.size, ITEM.size,
+                         pages_offset, items_offset, icons_offset, strings_offset, len(strings.data))
+    data = bytearray(header + body)
+    align(data)
+    data += struct.pack("<I", binascii.crc32(data) & 0xFFFFFFFF)
+    return bytes(data)
+
+
+def c_array(name, data):
+    lines = ["// Generated by tools/menu_compile.py", "#include <stdint.h>", "",
+             "alignas(4) const uint8_t %s[] = {" % name]
+    for start in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[start:start + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def dump(data):
+    fields = HEADER.unpack_from(data)
+    (magic, version, header_size, size, page_count, item_count, icon_count, page_size, item_size,
+     pages_offset, items_offset, icons_offset, strings_offset, strings_size) = fields
+    if magic != MAGIC:
+        raise DescriptionError("not a menu descriptor")
+    crc_ok = binascii.crc32(data[:size - 4]) & 0xFFFFFFFF == struct.unpack_from("<I", data, size - 4)[0]
+    print("version %d.%d, %d bytes, %d pages, %d items, %d icons, checksum %s"
+          % (version >> 8, version & 0xFF, size, page_count, item_count, icon_count, "ok" if crc_ok else "BAD"))
+
+    def string(offset):
+        start = strings_offset + offset
+        return data[start:data.index(b"\0", start)].decode("utf-8")
+
+    types = dict((v, k) for k, v in ITEM_TYPES.items())
+    for p in range(page_count):
+        icon, first, count, _, flags = PAGE.unpack_from(data, pages_offset + p * page_size)
+        name = BUILTIN_ICONS[icon] if icon < len(BUILTIN_ICONS) else "custom %d" % (icon - ICON_CUSTOM)
+        print("page %s%s" % (name, " save" if flags & 0x01 else ""))
+        for i in range(first, first + count):
+            label, key, options, callback, kind, flags, _, low, high, step, initial = \
+                ITEM.unpack_from(data, items_offset + i * item_size)
+            extra = ""
+            if options != NO_STRING:
+                names, offset = [], options
+                for _ in range(low, high + 1):
+                    names.append(string(offset))
+                    offset += len(names[-1].encode("utf-8")) + 1
+                extra = " " + "|".join(names)
+            extra += "".join(" " + name for name, bit in sorted(ITEM_FLAGS.items()) if flags & bit)
+            print("  %-4s %-16s %d..%d step %d initial %d%s%s%s" % (
+                types.get(kind, "?"), '"%s"' % string(label), low, high, step, initial, extra,
+                " key=%s" % string(key) if key != NO_STRING else "",
+                " callback=%d" % callback if callback != NO_CALLBACK else ""))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="menu description, or a compiled descriptor with --dump")
+    parser.add_argument("-o", "--output", help="output file (default: stdout for --c-array)")
+    parser.add_argument("--c-array", metavar="NAME", help="write a C++ header with a const array instead of binary")
+    parser.add_argument("--dump", action="store_true", help="print the content of a compiled descriptor")
+    args = parser.parse_args()
+
+    try:
+        if args.dump:
+            with open(args.input, "rb") as binary:
+                dump(binary.read())
+            return
+        data = build(*parse(args.input))
+    except (DescriptionError, OSError, KeyError, struct.error) as error:
+        sys.exit("%s: %s" % (args.input, error))
+
+    if args.c_array:
+        text = c_array(args.c_array, data)
+        if args.output:
+            with open(args.output, "w") as header:
+                header.write(text)
+        else:
+            sys.stdout.write(text)
+    else:
+        if not args.output:
+            sys.exit("binary output needs -o")
+        with open(args.output, "wb") as binary:
+            binary.write(data)
+    print("%d bytes" % len(data), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Rebuilds the frames of a simpleUI frame mirror stream (Container::setMirror(), see frameMirror.h).
+
+Usage:
+  mirror_decode.py capture.bin [--pbm frames/] [--quiet]
+  mirror_decode.py /dev/ttyACM0 --serial [--baud 115200]
+
+Frames are printed as text, one character per pixel, or written as PBM images with --pbm. Messages with a bad
+checksum are skipped; after a skipped message or a gap in the sequence numbers nothing is shown until the next
+keyframe.
+"""
+
+import argparse
+import binascii
+import os
+import struct
+import sys
+
+MAGIC = b"FM"
+HEADER = struct.Struct("<HHBHBH")  # magic, sequence, flags, width, pages, page mask
+FLAG_KEYFRAME = 0x01
+MAX_PAGES = 16
+
+
+def decode_page(data, width):
+    delta = bytearray()
+    i = 0
+    while i < len(data):
+        token = data[i]
+        i += 1
+        if token < 0x80:
+            delta += data[i:i + token + 1]
+            i += token + 1
+        elif token < 0xC0:
+            delta += bytes(token - 0x80 + 1)
+        else:
+            delta += bytes([data[i]]) * (token - 0xC0 + 2)
+            i += 1
+    if len(delta) != width:
+        raise ValueError("page decodes to %d bytes, expected %d" % (len(delta), width))
+    return delta
+
+
+def messages(stream):
+    """Yields (sequence, flags, width, pages, {page: delta}), or None for a message that failed its checks."""
+    buffer = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buffer += chunk
+        while True:
+            start = buffer.find(MAGIC)
+            if start < 0:
+                buffer = buffer[-1:]
+                break
+            buffer = buffer[start:]
+            if len(buffer) < HEADER.size:
+                break
+            _, sequence, flags, width, pages, mask = HEADER.unpack_from(buffer)
+            if pages == 0 or pages > MAX_PAGES or mask >> pages:
+                buffer = buffer[1:]  # not a header, only the magic bytes
+                continue
+            offset = HEADER.size
+            sizes_known = True
+            for page in range(pages):
+                if mask & (1 << page):
+                    if len(buffer) < offset + 2:
+                        sizes_known = False
+                        break
+                    offset += 2 + struct.unpack_from("<H", buffer, offset)[0]
+            if not sizes_known or len(buffer) < offset + 4:
+                break
+            crc = struct.unpack_from("<I", buffer, offset)[0]
+            if binascii.crc32(buffer[:offset]) & 0xFFFFFFFF != crc:
+                yield None
+                buffer = buffer[1:]
+                continue
+            deltas = {}
+            position = HEADER.size
+            try:
+                for page in range(pages):
+                    if mask & (1 << page):
+                        size = struct.unpack_from("<H", buffer, position)[0]
+                        deltas[page] = decode_page(buffer[position + 2:position + 2 + size], width)
+                        position += 2 + size
+            except (ValueError, IndexError):
+                yield None
+                buffer = buffer[1:]
+                continue
+            yield sequence, flags, width, pages, deltas
+            buffer = buffer[offset + 4:]
+
+
+def pixels(frame, width, pages):
+    """Rows of booleans: the buffer is page-major, bit n of a byte is row 8 * page + n."""
+    return [[bool(frame[(y // 8) * width + x] >> (y % 8) & 1) for x in range(width)] for y in range(pages * 8)]
+
+
+def write_pbm(path, rows):
+    with open(path, "w") as image:
+        image.write("P1\n%d %d\n" % (len(rows[0]), len(rows)))
+        for row in rows:
+            image.write(" ".join("1" if on else "0" for on in row) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="capture file, '-' for stdin, or a serial port with --serial")
+    parser.add_argument("--serial", action="store_true", help="read from a serial port (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--pbm", metavar="DIR", help="write frame_NNNNN.pbm files instead of printing frames")
+    parser.add_argument("--quiet", action="store_true", help="only print the summary")
+    args = parser.parse_args()
+
+    if args.serial:
+        import serial
+
+        stream = serial.Serial(args.input, args.baud)
+    elif args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+    if args.pbm:
+        os.makedirs(args.pbm, exist_ok=True)
+
+    frame = None
+    expected = None
+    shown = bad = lost = 0
+    for message in messages(stream):
+        if message is None:
+            bad += 1
+            frame = None
+            continue
+        sequence, flags, width, pages, deltas = message
+        if expected is not None and sequence != expected:
+            lost += (sequence - expected) & 0xFFFF
+            frame = None
+        expected = (sequence + 1) & 0xFFFF
+        if flags & FLAG_KEYFRAME:
+            frame = bytearray(width * pages)
+        elif frame is None or len(frame) != width * pages:
+            continue  # waiting for a keyframe
+        for page, delta in deltas.items():
+            row = frame[page * width:(page + 1) * width]
+            frame[page * width:(page + 1) * width] = bytes(a ^ b for a, b in zip(row, delta))
+
+        if args.pbm:
+            write_pbm(os.path.join(args.pbm, "frame_%05d.pbm" % shown), pixels(frame, width, pages))
+        elif not args.quiet:
+            print("-- frame %d (sequence %d%s)" % (shown, sequence, ", keyframe" if flags & FLAG_KEYFRAME else ""))
+            for row in pixels(frame, width, pages):
+                print("".join("#" if on else "." for on in row))
+        shown += 1
+
+    print("%d frames, %d messages lost, %d rejected" % (shown, lost, bad), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
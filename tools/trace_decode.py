@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Decodes a binary simpleUI trace capture (traceStartDrainTask(TRACE_OUTPUT_BINARY)).
+
+Usage:
+  trace_decode.py capture.bin [--mhz 160] [--trace-h src/trace.h]
+  trace_decode.py /dev/ttyACM0 --serial [--baud 115200]
+
+Format strings are read from the SIMPLEUI_TRACE_POINTS table in trace.h, so the capture only needs to match
+the header of the firmware that produced it. Gaps in the sequence numbers are reported as lost records.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+FRAME_SYNC = b"\xa5\x5a"
+RECORD = struct.Struct("<IIHH3I")  # sequence, cycles, id, argCount, args[3]
+
+
+def load_formats(path):
+    with open(path) as header:
+        text = header.read()
+    return [m.group(2) for m in re.finditer(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', text)]
+
+
+def records(stream):
+    buffer = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buffer += chunk
+        while True:
+            start = buffer.find(FRAME_SYNC)
+            if start < 0:
+                buffer = buffer[-1:]
+                break
+            end = start + len(FRAME_SYNC) + RECORD.size
+            if len(buffer) < end:
+                buffer = buffer[start:]
+                break
+            yield RECORD.unpack(buffer[start + len(FRAME_SYNC):end])
+            buffer = buffer[end:]
+
+
+def main():
+    default_header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "trace.h")
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="capture file, '-' for stdin, or a serial port with --serial")
+    parser.add_argument("--serial", action="store_true", help="read from a serial port (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--mhz", type=float, default=160.0, help="CPU clock, to convert cycles to microseconds")
+    parser.add_argument("--trace-h", default=default_header, help="trace.h with the trace point table")
+    args = parser.parse_args()
+
+    formats = load_formats(args.trace_h)
+    if args.serial:
+        import serial
+
+        stream = serial.Serial(args.input, args.baud)
+    elif args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+
+    expected = None
+    first_cycles = None
+    last_cycles = 0
+    elapsed = 0
+    for sequence, cycles, trace_id, arg_count, a0, a1, a2 in records(stream):
+        if expected is not None and sequence != expected:
+            print("-- %d records lost" % ((sequence - expected) & 0xFFFFFFFF))
+        expected = (sequence + 1) & 0xFFFFFFFF
+
+        if first_cycles is None:
+            first_cycles = last_cycles = cycles
+        elapsed += (cycles - last_cycles) & 0xFFFFFFFF  # the cycle counter wraps every few seconds
+        last_cycles = cycles
+
+        if trace_id < len(formats):
+            fmt = formats[trace_id].replace("%l", "%")
+            text = fmt % (a0, a1, a2)[: fmt.count("%") - 2 * fmt.count("%%")]
+        else:
+            text = "unknown trace point %d args %d %d %d" % (trace_id, a0, a1, a2)
+        print("%12.1f us  #%-8d %s" % (elapsed / args.mhz, sequence, text))
+
+
+if __name__ == "__main__":
+    main()